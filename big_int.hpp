@@ -1,6 +1,14 @@
 #include <iostream>
 #include <climits>
 #include <cassert>
+#include <cstdint>
+#include <string>
+#include <array>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <random>
 
 #ifndef BIG_INT_H
 #define BIG_INT_H
@@ -14,6 +22,14 @@ namespace alexstrong {
 
   static constexpr char uppercase_digits[37] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
   static constexpr char lowercase_digits[37] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+  //value of a digit in any base <= 36, or 36 if it isn't one
+  inline int digit_value(char c) noexcept {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'z') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'Z') return c - 'A' + 10;
+    return 36;
+  }
   
   template<int A, int B>
   struct IntUtils {
@@ -26,6 +42,540 @@ namespace alexstrong {
     static constexpr int sum_bits = max+CHAR_BIT;
   };
 
+  //word-sized arithmetic on little-endian arrays of limbs.
+  //big_int keeps its bytes most significant first, so anything that needs
+  //real speed converts to limbs, works here, and converts back.
+  struct LimbKernels {
+    typedef std::uint32_t limb;
+    typedef std::uint64_t wide;
+    static constexpr int limb_bits = 32;
+    static constexpr int limb_bytes = sizeof(limb);
+
+    static constexpr int limbs_for_bytes(int bytes) {
+      return (bytes + limb_bytes - 1) / limb_bytes;
+    }
+
+    //big-endian bytes to little-endian limbs, zero padded
+    static void from_bytes(limb *dst, int n, const unsigned char *src, int bytes) {
+      for(int i = 0; i < n; i++) dst[i] = 0;
+      for(int i = 0; i < bytes && i < n*limb_bytes; i++) {
+	dst[i/limb_bytes] |= (limb)src[bytes-1-i] << ((i%limb_bytes)*CHAR_BIT);
+      }
+    }
+
+    //little-endian limbs to big-endian bytes, truncated or zero padded
+    static void to_bytes(unsigned char *dst, int bytes, const limb *src, int n) {
+      for(int i = 0; i < bytes; i++) {
+	dst[bytes-1-i] = (i/limb_bytes < n) ? (unsigned char)(src[i/limb_bytes] >> ((i%limb_bytes)*CHAR_BIT)) : 0;
+      }
+    }
+
+    //number of limbs once leading zero limbs are dropped
+    static int size(const limb *a, int n) {
+      while(n > 0 && a[n-1] == 0) n--;
+      return n;
+    }
+
+    static bool is_zero(const limb *a, int n) {
+      return size(a, n) == 0;
+    }
+
+    static void copy(limb *dst, const limb *src, int n) {
+      for(int i = 0; i < n; i++) dst[i] = src[i];
+    }
+
+    static void zero(limb *dst, int n) {
+      for(int i = 0; i < n; i++) dst[i] = 0;
+    }
+
+    static void set_wide(limb *dst, int n, wide value) {
+      zero(dst, n);
+      if(n > 0) dst[0] = (limb)value;
+      if(n > 1) dst[1] = (limb)(value >> limb_bits);
+    }
+
+    //low two limbs as one wide value
+    static wide get_wide(const limb *a, int n) {
+      wide ret = 0;
+      if(n > 0) ret = a[0];
+      if(n > 1) ret |= (wide)a[1] << limb_bits;
+      return ret;
+    }
+
+    //-1, 0 or 1 as a is less than, equal to or greater than b
+    static int cmp(const limb *a, int na, const limb *b, int nb) {
+      na = size(a, na);
+      nb = size(b, nb);
+      if(na != nb) return (na < nb) ? -1 : 1;
+      for(int i = na-1; i >= 0; i--) {
+	if(a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+      }
+      return 0;
+    }
+
+    static int clz(limb x) {
+      if(x == 0) return limb_bits;
+      int ret = 0;
+      for(int step = limb_bits/2; step > 0; step /= 2) {
+	if(!(x >> (limb_bits-step))) {
+	  ret += step;
+	  x <<= step;
+	}
+      }
+      return ret;
+    }
+
+    static int ctz(limb x) {
+      if(x == 0) return limb_bits;
+      int ret = 0;
+      while(!(x & 1)) {
+	x >>= 1;
+	ret++;
+      }
+      return ret;
+    }
+
+    static int bit_length(const limb *a, int n) {
+      n = size(a, n);
+      if(n == 0) return 0;
+      return n*limb_bits - clz(a[n-1]);
+    }
+
+    //trailing zero bits of a nonzero number
+    static int trailing_zeros(const limb *a, int n) {
+      int i = 0;
+      while(i < n && a[i] == 0) i++;
+      if(i == n) return 0;
+      return i*limb_bits + ctz(a[i]);
+    }
+
+    static bool test_bit(const limb *a, int n, int bit) {
+      if(bit/limb_bits >= n) return false;
+      return (a[bit/limb_bits] >> (bit%limb_bits)) & 1;
+    }
+
+    //clear every bit at or above the given position
+    static void mask_bits(limb *a, int n, int bits) {
+      for(int i = 0; i < n; i++) {
+	int low = i*limb_bits;
+	if(low >= bits) a[i] = 0;
+	else if(bits - low < limb_bits) a[i] &= ((limb)1 << (bits-low)) - 1;
+      }
+    }
+
+    //r = a + b over n limbs, returns the carry out; r may alias a or b
+    static limb add_n(limb *r, const limb *a, const limb *b, int n) {
+      wide carry = 0;
+      for(int i = 0; i < n; i++) {
+	carry += (wide)a[i] + b[i];
+	r[i] = (limb)carry;
+	carry >>= limb_bits;
+      }
+      return (limb)carry;
+    }
+
+    //r = a + b for a single limb b
+    static limb add_1(limb *r, const limb *a, int n, limb b) {
+      wide carry = b;
+      for(int i = 0; i < n; i++) {
+	carry += a[i];
+	r[i] = (limb)carry;
+	carry >>= limb_bits;
+      }
+      return (limb)carry;
+    }
+
+    //r = a - b over n limbs, returns the borrow out
+    static limb sub_n(limb *r, const limb *a, const limb *b, int n) {
+      limb borrow = 0;
+      for(int i = 0; i < n; i++) {
+	wide diff = (wide)a[i] - b[i] - borrow;
+	r[i] = (limb)diff;
+	borrow = (limb)(diff >> (2*limb_bits-1));
+      }
+      return borrow;
+    }
+
+    static limb sub_1(limb *r, const limb *a, int n, limb b) {
+      limb borrow = b;
+      for(int i = 0; i < n; i++) {
+	wide diff = (wide)a[i] - borrow;
+	r[i] = (limb)diff;
+	borrow = (limb)(diff >> (2*limb_bits-1));
+      }
+      return borrow;
+    }
+
+    //r = a + b where a has na >= nb limbs
+    static limb add(limb *r, const limb *a, int na, const limb *b, int nb) {
+      limb carry = add_n(r, a, b, nb);
+      return add_1(r+nb, a+nb, na-nb, carry);
+    }
+
+    //r = a - b where a has na >= nb limbs
+    static limb sub(limb *r, const limb *a, int na, const limb *b, int nb) {
+      limb borrow = sub_n(r, a, b, nb);
+      return sub_1(r+nb, a+nb, na-nb, borrow);
+    }
+
+    //two's-complement negation in place
+    static void neg(limb *a, int n) {
+      for(int i = 0; i < n; i++) a[i] = ~a[i];
+      add_1(a, a, n, 1);
+    }
+
+    //r = a * m, returns the high limb
+    static limb mul_1(limb *r, const limb *a, int n, limb m) {
+      wide carry = 0;
+      for(int i = 0; i < n; i++) {
+	carry += (wide)a[i] * m;
+	r[i] = (limb)carry;
+	carry >>= limb_bits;
+      }
+      return (limb)carry;
+    }
+
+    //r += a * m, returns the carry limb
+    static limb addmul_1(limb *r, const limb *a, int n, limb m) {
+      wide carry = 0;
+      for(int i = 0; i < n; i++) {
+	carry += (wide)a[i] * m + r[i];
+	r[i] = (limb)carry;
+	carry >>= limb_bits;
+      }
+      return (limb)carry;
+    }
+
+    //r -= a * m, returns the borrow limb
+    static limb submul_1(limb *r, const limb *a, int n, limb m) {
+      wide borrow = 0;
+      for(int i = 0; i < n; i++) {
+	wide prod = (wide)a[i] * m + borrow;
+	limb low = (limb)prod;
+	borrow = prod >> limb_bits;
+	if(r[i] < low) borrow++;
+	r[i] -= low;
+      }
+      return (limb)borrow;
+    }
+
+    //r = a * b, r has na+nb limbs and must not overlap a or b
+    static void mul(limb *r, const limb *a, int na, const limb *b, int nb) {
+      zero(r, na+nb);
+      for(int j = 0; j < nb; j++) {
+	r[na+j] = b[j] ? addmul_1(r+j, a, na, b[j]) : 0;
+      }
+    }
+
+    //low n limbs of a * b, for arithmetic that wraps around;
+    //r must not overlap a or b
+    static void mul_low(limb *r, const limb *a, const limb *b, int n) {
+      zero(r, n);
+      for(int j = 0; j < n; j++) {
+	if(b[j]) addmul_1(r+j, a, n-j, b[j]);
+      }
+    }
+
+    //r = a * m for a two-limb multiplier, r has n+2 limbs
+    static void mul_wide(limb *r, const limb *a, int n, wide m) {
+      r[n] = mul_1(r, a, n, (limb)m);
+      r[n+1] = addmul_1(r+1, a, n, (limb)(m >> limb_bits));
+    }
+
+    //q = a / d, returns a % d; q may alias a or be null
+    static limb divmod_1(limb *q, const limb *a, int n, limb d) {
+      wide rem = 0;
+      for(int i = n-1; i >= 0; i--) {
+	rem = (rem << limb_bits) | a[i];
+	if(q) q[i] = (limb)(rem / d);
+	rem %= d;
+      }
+      return (limb)rem;
+    }
+
+    //largest power of base that fits in a limb, and its exponent
+    static limb chunk_power(int base, int &digits) {
+      limb ret = base;
+      digits = 1;
+      while((wide)ret * base <= (limb)~(limb)0) {
+	ret *= base;
+	digits++;
+      }
+      return ret;
+    }
+
+    //shift left in place by any number of bits, dropping what falls off the top
+    static void shl(limb *a, int n, int bits) {
+      int limbs = bits / limb_bits;
+      int rem = bits % limb_bits;
+      for(int i = n-1; i >= 0; i--) {
+	limb hi = (i-limbs >= 0) ? a[i-limbs] : 0;
+	limb lo = (i-limbs-1 >= 0) ? a[i-limbs-1] : 0;
+	a[i] = rem ? ((hi << rem) | (lo >> (limb_bits-rem))) : hi;
+      }
+    }
+
+    //logical shift right in place by any number of bits
+    static void shr(limb *a, int n, int bits) {
+      int limbs = bits / limb_bits;
+      int rem = bits % limb_bits;
+      for(int i = 0; i < n; i++) {
+	limb lo = (i+limbs < n) ? a[i+limbs] : 0;
+	limb hi = (i+limbs+1 < n) ? a[i+limbs+1] : 0;
+	a[i] = rem ? ((lo >> rem) | (hi << (limb_bits-rem))) : lo;
+      }
+    }
+
+    //the 64 bits of a starting at the given bit position
+    static wide extract_wide(const limb *a, int n, int bit) {
+      wide ret = 0;
+      int first = bit / limb_bits;
+      int rem = bit % limb_bits;
+      for(int i = 2; i >= 0; i--) {
+	wide part = (first+i < n) ? a[first+i] : 0;
+	int pos = i*limb_bits - rem;
+	if(pos >= 0 && pos < 2*limb_bits) ret |= part << pos;
+	else if(pos < 0) ret |= part >> -pos;
+      }
+      return ret;
+    }
+
+    //schoolbook long division (Knuth, algorithm D)
+    //q gets na limbs and r gets nb limbs; either may be null.
+    //b must be nonzero.
+    static void divmod(limb *q, limb *r, const limb *a, int na, const limb *b, int nb) {
+      if(q) zero(q, na);
+      if(r) zero(r, nb);
+      nb = size(b, nb);
+      assert(nb > 0);
+      int sa = size(a, na);
+      if(sa < nb) {
+	if(r) copy(r, a, sa);
+	return;
+      }
+      if(nb == 1) {
+	limb rem = divmod_1(q, a, sa, b[0]);
+	if(r) r[0] = rem;
+	return;
+      }
+      int s = clz(b[nb-1]);
+      std::vector<limb> un(sa+1), vn(nb);
+      copy(vn.data(), b, nb);
+      shl(vn.data(), nb, s);
+      copy(un.data(), a, sa);
+      un[sa] = 0;
+      shl(un.data(), sa+1, s);
+      const wide base = (wide)1 << limb_bits;
+      for(int j = sa-nb; j >= 0; j--) {
+	wide num = ((wide)un[j+nb] << limb_bits) | un[j+nb-1];
+	wide qhat = num / vn[nb-1];
+	wide rhat = num % vn[nb-1];
+	while(qhat >= base || qhat*vn[nb-2] > ((rhat << limb_bits) | un[j+nb-2])) {
+	  qhat--;
+	  rhat += vn[nb-1];
+	  if(rhat >= base) break;
+	}
+	limb borrow = submul_1(un.data()+j, vn.data(), nb, (limb)qhat);
+	bool negative = un[j+nb] < borrow;
+	un[j+nb] -= borrow;
+	if(negative) {
+	  qhat--;
+	  un[j+nb] += add_n(un.data()+j, un.data()+j, vn.data(), nb);
+	}
+	if(q) q[j] = (limb)qhat;
+      }
+      if(r) {
+	shr(un.data(), nb, s);
+	copy(r, un.data(), nb);
+      }
+    }
+
+    //binary GCD on a single wide word
+    static wide gcd_wide(wide a, wide b) {
+      if(a == 0) return b;
+      if(b == 0) return a;
+      int shift = 0;
+      while(!((a | b) & 1)) {
+	a >>= 1;
+	b >>= 1;
+	shift++;
+      }
+      while(!(a & 1)) a >>= 1;
+      while(b) {
+	while(!(b & 1)) b >>= 1;
+	if(a > b) std::swap(a, b);
+	b -= a;
+      }
+      return a << shift;
+    }
+
+    //true if base^k <= x, without overflowing
+    static bool pow_leq_wide(wide base, int k, wide x) {
+      wide p = 1;
+      for(int i = 0; i < k; i++) {
+	if(base != 0 && p > x / base) return false;
+	p *= base;
+      }
+      return p <= x;
+    }
+
+    //floor of the k-th root of a single wide word
+    static wide root_wide(wide x, int k) {
+      if(x == 0 || k == 1) return x;
+      wide r = (wide)std::pow((double)x, 1.0/k);
+      while(r > 0 && !pow_leq_wide(r, k, x)) r--;
+      while(pow_leq_wide(r+1, k, x)) r++;
+      return r;
+    }
+
+    //b^e mod m for a one-limb m
+    static limb pow_mod_1(limb b, wide e, limb m) {
+      wide ret = 1 % m, x = b % m;
+      while(e) {
+	if(e & 1) ret = ret * x % m;
+	x = x * x % m;
+	e >>= 1;
+      }
+      return (limb)ret;
+    }
+
+    //deterministic Miller-Rabin for one limb; bases 2, 7 and 61 are enough
+    //below 2^32
+    static bool is_prime_1(limb n) {
+      if(n < 2) return false;
+      for(limb p : {2u, 3u, 5u, 7u, 61u}) {
+	if(n % p == 0) return n == p;
+      }
+      limb d = n-1;
+      int s = 0;
+      while(!(d & 1)) {
+	d >>= 1;
+	s++;
+      }
+      for(limb a : {2u, 7u, 61u}) {
+	wide x = pow_mod_1(a, d, n);
+	bool composite = x != 1 && x != n-1;
+	for(int i = 1; i < s && composite; i++) {
+	  x = x * x % n;
+	  composite = x != n-1;
+	}
+	if(composite) return false;
+      }
+      return true;
+    }
+
+    //-1/m mod 2^32 for odd m, the constant Montgomery reduction needs
+    static limb inverse_limb(limb m) {
+      limb x = m;
+      for(int i = 0; i < 5; i++) x *= 2 - m*x;
+      return (limb)0 - x;
+    }
+
+    //Jacobi symbol (a/n) for odd n
+    static int jacobi_wide(wide a, wide n) {
+      int ret = 1;
+      a %= n;
+      while(a != 0) {
+	while(!(a & 1)) {
+	  a >>= 1;
+	  if((n & 7) == 3 || (n & 7) == 5) ret = -ret;
+	}
+	std::swap(a, n);
+	if((a & 3) == 3 && (n & 3) == 3) ret = -ret;
+	a %= n;
+      }
+      return (n == 1) ? ret : 0;
+    }
+  };
+
+  //odd primes below 2^16, shared by trial division and sieving.
+  //Runs of them are multiplied together while the product still fits in a
+  //limb, so reducing a big number by all of them takes one divmod_1 per run.
+  struct SmallPrimes {
+    typedef LimbKernels::limb limb;
+    static constexpr limb bound = 1 << 16;
+
+    struct group {
+      limb product;
+      int first;
+      int last;
+    };
+
+    static const std::vector<limb> &primes() {
+      static const std::vector<limb> table = sieve();
+      return table;
+    }
+
+    static const std::vector<group> &groups() {
+      static const std::vector<group> table = make_groups();
+      return table;
+    }
+
+    //a mod each of the first count primes
+    static void residues(limb *out, const limb *a, int n, int count) {
+      const std::vector<limb> &p = primes();
+      for(const group &g : groups()) {
+	if(g.first >= count) break;
+	limb rem = LimbKernels::divmod_1(nullptr, a, n, g.product);
+	for(int i = g.first; i < g.last && i < count; i++) out[i] = rem % p[i];
+      }
+    }
+
+  private:
+    static std::vector<limb> sieve() {
+      std::vector<bool> composite(bound, false);
+      std::vector<limb> ret;
+      for(limb i = 3; i < bound; i += 2) {
+	if(composite[i]) continue;
+	ret.push_back(i);
+	for(limb j = i*i; j < bound; j += 2*i) composite[j] = true;
+      }
+      return ret;
+    }
+
+    static std::vector<group> make_groups() {
+      const std::vector<limb> &p = primes();
+      std::vector<group> ret;
+      int i = 0;
+      while(i < (int)p.size()) {
+	group g;
+	g.product = 1;
+	g.first = i;
+	while(i < (int)p.size() && (LimbKernels::wide)g.product * p[i] <= 0xFFFFFFFFu) {
+	  g.product *= p[i];
+	  i++;
+	}
+	g.last = i;
+	ret.push_back(g);
+      }
+      return ret;
+    }
+  };
+
+  //byte order for export_bytes and import_bytes
+  enum class byte_order {
+    big_endian,
+    little_endian
+  };
+
+  template<int N>
+  class big_uint;
+
+  template<int N>
+  class big_int_parser;
+
+  template<int N>
+  class big_int_formatter;
+
+  template<int N>
+  class big_int_accumulator;
+
+  template<int N>
+  class big_int_sorter;
+
+  template<int N>
+  class rns_int;
+
   template<int N>
   class big_int {
     static_assert(N % CHAR_BIT == 0, "Invalid number of bits; " STRINGIFY(N) " is not a multiple of " STRINGIFY(CHAR_BIT));
@@ -105,6 +655,8 @@ namespace alexstrong {
 	      ret.quotient -= quot;
 	    }
 	    numOff++;
+	    //shifted was abs_other itself, so the remainder is already reduced
+	    if(numOff > diff-1) break;
 	    shifted = abs_other << ((diff-1-numOff)*CHAR_BIT);
 	    quot >>= CHAR_BIT;
 	  }
@@ -119,112 +671,624 @@ namespace alexstrong {
 
     static const int byte_mask = (1 << CHAR_BIT) - 1;
 
-    std::string convert_to_base(const int &value, const int &base) {
-      std::string ret = "";
-      int cpy = value;
-      while(cpy > 0) {
-	std::string curr_digit(1, uppercase_digits[cpy%base]);
-	ret.insert(0, curr_digit);
-	cpy /= base;
+    //stops at the first character that isn't a digit, so "", "+" and "-" are 0
+    void parse(const std::string &value, int base) noexcept {
+      big_int_parser<N> parser(base);
+      parser.feed(value.data(), value.length());
+      *this = parser.value();
+    }
+
+    //get the most significant byte that is not equal to 0
+    //return -1 if the number is equal to 0
+    int msb() {
+      for(int i = 0; i < N/CHAR_BIT; i++) {
+	if(bitmap[i] != 0) {
+	  return N/CHAR_BIT-i-1;
+	}
       }
+      return -1;
+    }
+    
+    //store the data
+    unsigned char bitmap[N/CHAR_BIT];
+
+    typedef LimbKernels::limb limb;
+    typedef LimbKernels::wide wide;
+
+    //enough limbs to hold the magnitude of any big_int<N>
+    static constexpr int num_limbs = LimbKernels::limbs_for_bytes(N/CHAR_BIT);
+
+    //leading bits looked at per Lehmer step; small enough that the
+    //cosequence never overflows a signed 64-bit word
+    static constexpr int lehmer_bits = 60;
+
+    //write |*this| into num_limbs limbs; returns true if *this is negative
+    bool to_magnitude(limb *dst) const noexcept {
+      LimbKernels::from_bytes(dst, num_limbs, bitmap, N/CHAR_BIT);
+      if(sign()) return false;
+      LimbKernels::neg(dst, num_limbs);
+      LimbKernels::mask_bits(dst, num_limbs, N);
+      return true;
+    }
+
+    //the low N bits of a magnitude, negated if asked
+    static big_int<N> from_magnitude(const limb *src, int n, bool negative) noexcept {
+      std::array<limb, num_limbs> tmp;
+      LimbKernels::zero(tmp.data(), num_limbs);
+      LimbKernels::copy(tmp.data(), src, (n < num_limbs) ? n : (int)num_limbs);
+      if(negative) LimbKernels::neg(tmp.data(), num_limbs);
+      big_int<N> ret;
+      LimbKernels::to_bytes(ret.bitmap, N/CHAR_BIT, tmp.data(), num_limbs);
       return ret;
     }
 
-    struct div_by_byte_data {
-      int base;
-      std::string quotient;
-      char remainder;
-      div_by_byte_data(int b=10, std::string q = "1", char r = '0') : base(b), quotient(q), remainder(r) {
-      }
-      div_by_byte_data &operator=(const div_by_byte_data &other) {
-	base = other.base;
-	quotient = other.quotient;
-	remainder = other.remainder;
-	return *this;
+    //r = a*u + b*v for a Lehmer cosequence, where a and b never have the
+    //same sign unless both are magnitudes; the result must fit in num_limbs
+    static void combine(limb *r, std::int64_t a, const limb *u, std::int64_t b, const limb *v) noexcept {
+      std::array<limb, num_limbs+2> pa, pb;
+      LimbKernels::mul_wide(pa.data(), u, num_limbs, (wide)(a < 0 ? -a : a));
+      LimbKernels::mul_wide(pb.data(), v, num_limbs, (wide)(b < 0 ? -b : b));
+      if(a >= 0 && b >= 0) LimbKernels::add_n(pa.data(), pa.data(), pb.data(), num_limbs+2);
+      else if(a >= 0) LimbKernels::sub_n(pa.data(), pa.data(), pb.data(), num_limbs+2);
+      else LimbKernels::sub_n(pa.data(), pb.data(), pa.data(), num_limbs+2);
+      LimbKernels::copy(r, pa.data(), num_limbs);
+    }
+
+    //Lehmer's GCD on magnitudes u >= v, leaving the gcd in u and 0 in v.
+    //If su and sv are given they follow the coefficient of one input: on
+    //entry they hold its coefficient in u and in v, on exit su holds the
+    //magnitude of its coefficient in the gcd. The sign of that coefficient
+    //flips once per Euclidean step, and steps counts them.
+    static void lehmer(limb *u, limb *v, limb *su, limb *sv, int &steps) noexcept {
+      const bool track = (su != nullptr);
+      std::array<limb, num_limbs> t1, t2, quot, rem;
+      std::array<limb, 2*num_limbs> prod;
+      steps = 0;
+      while(!LimbKernels::is_zero(v, num_limbs)) {
+	int ubits = LimbKernels::bit_length(u, num_limbs);
+	//small enough for a binary GCD on one word
+	if(!track && ubits <= 2*LimbKernels::limb_bits) {
+	  wide g = LimbKernels::gcd_wide(LimbKernels::get_wide(u, num_limbs), LimbKernels::get_wide(v, num_limbs));
+	  LimbKernels::set_wide(u, num_limbs, g);
+	  LimbKernels::zero(v, num_limbs);
+	  return;
+	}
+	//run the Euclidean algorithm on the leading bits only (Knuth, algorithm L)
+	int shift = (ubits > lehmer_bits) ? ubits - lehmer_bits : 0;
+	std::int64_t x = (std::int64_t)LimbKernels::extract_wide(u, num_limbs, shift);
+	std::int64_t y = (std::int64_t)LimbKernels::extract_wide(v, num_limbs, shift);
+	std::int64_t A = 1, B = 0, C = 0, D = 1;
+	int k = 0;
+	while(y + C > 0 && y + D > 0 && x + A >= 0 && x + B >= 0) {
+	  std::int64_t q = (x + A) / (y + C);
+	  if(q != (x + B) / (y + D)) break;
+	  std::int64_t T = A - q*C;
+	  A = C;
+	  C = T;
+	  T = B - q*D;
+	  B = D;
+	  D = T;
+	  T = x - q*y;
+	  x = y;
+	  y = T;
+	  k++;
+	}
+	if(B == 0) {
+	  //the leading bits weren't enough; take one full step instead
+	  LimbKernels::divmod(quot.data(), rem.data(), u, num_limbs, v, num_limbs);
+	  if(track) {
+	    LimbKernels::mul(prod.data(), quot.data(), num_limbs, sv, num_limbs);
+	    LimbKernels::add_n(t1.data(), su, prod.data(), num_limbs);
+	    LimbKernels::copy(su, sv, num_limbs);
+	    LimbKernels::copy(sv, t1.data(), num_limbs);
+	  }
+	  LimbKernels::copy(u, v, num_limbs);
+	  LimbKernels::copy(v, rem.data(), num_limbs);
+	  steps++;
+	}
+	else {
+	  combine(t1.data(), A, u, B, v);
+	  combine(t2.data(), C, u, D, v);
+	  LimbKernels::copy(u, t1.data(), num_limbs);
+	  LimbKernels::copy(v, t2.data(), num_limbs);
+	  if(track) {
+	    //the cofactors alternate in sign, so their magnitudes just add
+	    combine(t1.data(), A < 0 ? -A : A, su, B < 0 ? -B : B, sv);
+	    combine(t2.data(), C < 0 ? -C : C, su, D < 0 ? -D : D, sv);
+	    LimbKernels::copy(su, t1.data(), num_limbs);
+	    LimbKernels::copy(sv, t2.data(), num_limbs);
+	  }
+	  steps += k;
+	}
       }
-    };
+    }
     
-    //TODO: long division by 1 << CHAR_BIT
-    //the value being divided should always be positive
-    div_by_byte_data divide_by_byte(const std::string &value, const int &base) {
-      std::string ret = "";
-      std::string curr_val = "";
-      char rem = 0;
-      int byte_val = 1 << CHAR_BIT;
-      for(unsigned i = 0; i < value.length(); i++) {
-	curr_val.push_back(value.at(i));
-	int curr_int_val = std::stoi(curr_val, NULL, base);
-	if(curr_int_val / byte_val > 0) {
-	  int curr_quot = curr_int_val / byte_val;
-	  int curr_rem = curr_int_val % byte_val;
-	  rem = (char)curr_rem;
-	  curr_val = convert_to_base(curr_rem, base);
-	  std::string quot_str = convert_to_base(curr_quot, base);
-	  ret.insert(ret.length(), quot_str);
+    //r = p if p has at most max_bits bits
+    static bool capped_copy(std::vector<limb> &r, const limb *p, int np, int max_bits) noexcept {
+      if(LimbKernels::bit_length(p, np) > max_bits) return false;
+      np = LimbKernels::size(p, np);
+      LimbKernels::zero(r.data(), (int)r.size());
+      LimbKernels::copy(r.data(), p, np);
+      return true;
+    }
+
+    //r = a^e, or false if that would have more than max_bits bits. Square
+    //and multiply from the top bit of e; every partial power divides a^e,
+    //so the cap can be checked as it goes.
+    static bool pow_capped(std::vector<limb> &r, const limb *a, int e, int max_bits) noexcept {
+      const int n = (int)r.size();
+      assert(max_bits <= n*LimbKernels::limb_bits && max_bits <= N);
+      std::vector<limb> prod(2*num_limbs);
+      LimbKernels::zero(r.data(), n);
+      r[0] = 1;
+      int na = LimbKernels::size(a, num_limbs);
+      int top = 0;
+      while((e >> top) > 1) top++;
+      for(int bit = top; bit >= 0 && e > 0; bit--) {
+	int nr = LimbKernels::size(r.data(), n);
+	LimbKernels::mul(prod.data(), r.data(), nr, r.data(), nr);
+	if(!capped_copy(r, prod.data(), 2*nr, max_bits)) return false;
+	if((e >> bit) & 1) {
+	  nr = LimbKernels::size(r.data(), n);
+	  LimbKernels::mul(prod.data(), r.data(), nr, a, na);
+	  if(!capped_copy(r, prod.data(), nr+na, max_bits)) return false;
 	}
-	else {
-	  rem = (char)(curr_int_val % byte_val);
-	  ret.push_back('0');
+      }
+      return true;
+    }
+
+    //a k-th power is 0 or a k-th power residue mod every prime q = 1 mod k,
+    //and for a random number each such q rules that out with probability
+    //1 - 1/k. For every prime k <= N this holds the first four such q below
+    //2^32; entries for composite k are 0.
+    static const std::vector<std::array<limb, 4>> &power_filters() {
+      static const std::vector<std::array<limb, 4>> table = make_power_filters();
+      return table;
+    }
+
+    static std::vector<std::array<limb, 4>> make_power_filters() {
+      std::vector<std::array<limb, 4>> ret(N+1, std::array<limb, 4>{});
+      for(int k = 2; k <= N; k++) {
+	if(!LimbKernels::is_prime_1(k)) continue;
+	int found = 0;
+	for(wide q = 2*(wide)k+1; q <= 0xFFFFFFFFu && found < 4; q += 2*(wide)k) {
+	  if(LimbKernels::is_prime_1((limb)q)) ret[k][found++] = (limb)q;
 	}
       }
-      int first_nonzero = 0;
-      while(first_nonzero < (int)ret.length() && ret.at(first_nonzero) == '0') first_nonzero++;
-      if(first_nonzero >= (int)(ret.length())) {
-	ret = "";
+      return ret;
+    }
+
+    //false if a (n limbs) is shown not to be a k-th power for a prime k
+    static bool power_residues_pass(const limb *a, int n, int k) noexcept {
+      for(limb q : power_filters()[k]) {
+	if(q == 0) break;
+	limb rem = LimbKernels::divmod_1(nullptr, a, n, q);
+	if(rem && LimbKernels::pow_mod_1(rem, (q-1)/k, q) != 1) return false;
+      }
+      return true;
+    }
+
+    //false if a (n limbs, with the given trailing zeros) can't be a k-th
+    //power; composite k are always rejected
+    static bool may_be_power(const limb *a, int n, int zeros, int k) noexcept {
+      //a k-th power has a multiple of k trailing zeros
+      if(zeros && zeros % k) return false;
+      if(power_filters()[k][0] == 0) return false;
+      //squares end in 0, 1, 4 or 9 mod 16
+      if(k == 2 && ((0x0213 >> (a[0] & 15)) & 1) == 0) return false;
+      return power_residues_pass(a, n, k);
+    }
+
+    //floor of the k-th root of a magnitude, by Newton's method. The root of
+    //the leading half of the bits seeds a full-size estimate, so only a
+    //couple of iterations ever run at full precision.
+    static void root_magnitude(limb *r, const limb *x, int k) noexcept {
+      int bits = LimbKernels::bit_length(x, num_limbs);
+      LimbKernels::zero(r, num_limbs);
+      if(bits == 0) return;
+      if(k == 1) {
+	LimbKernels::copy(r, x, num_limbs);
+	return;
+      }
+      if(k >= bits) {
+	r[0] = 1;
+	return;
+      }
+      if(bits <= 2*LimbKernels::limb_bits) {
+	LimbKernels::set_wide(r, num_limbs, LimbKernels::root_wide(LimbKernels::get_wide(x, num_limbs), k));
+	return;
+      }
+      //start from something at least as big as the root
+      int s = bits / (2*k);
+      if(s == 0) {
+	int e = (bits + k - 1) / k;
+	r[e/LimbKernels::limb_bits] = (limb)1 << (e%LimbKernels::limb_bits);
       }
       else {
-	ret = ret.substr(first_nonzero);
+	std::array<limb, num_limbs> hi = {};
+	LimbKernels::copy(hi.data(), x, num_limbs);
+	LimbKernels::shr(hi.data(), num_limbs, k*s);
+	root_magnitude(r, hi.data(), k);
+	LimbKernels::add_1(r, r, num_limbs, 1);
+	LimbKernels::shl(r, num_limbs, s);
+      }
+      //r = ((k-1)*r + x/r^(k-1)) / k only ever decreases until it hits the root
+      std::vector<limb> pw(2*num_limbs+1);
+      std::array<limb, num_limbs> quot;
+      std::array<limb, num_limbs+1> next;
+      while(true) {
+	if(k == 2) {
+	  LimbKernels::divmod(quot.data(), nullptr, x, num_limbs, r, num_limbs);
+	}
+	else if(pow_capped(pw, r, k-1, bits)) {
+	  LimbKernels::divmod(quot.data(), nullptr, x, num_limbs, pw.data(), (int)pw.size());
+	}
+	else {
+	  LimbKernels::zero(quot.data(), num_limbs);
+	}
+	next[num_limbs] = LimbKernels::mul_1(next.data(), r, num_limbs, (limb)(k-1));
+	LimbKernels::add(next.data(), next.data(), num_limbs+1, quot.data(), num_limbs);
+	LimbKernels::divmod_1(next.data(), next.data(), num_limbs+1, (limb)k);
+	if(LimbKernels::cmp(next.data(), num_limbs+1, r, num_limbs) >= 0) break;
+	LimbKernels::copy(r, next.data(), num_limbs);
       }
-      div_by_byte_data dbbd(base, ret, rem);
-      return dbbd;
     }
 
-    void parse(const std::string &value, int base) {
-      if(value.length() == 0) {
-	for(int i = 0; i < N/CHAR_BIT; i++) {
-	  bitmap[i] = 0;
+    //arithmetic modulo an odd m in Montgomery form, with R = 2^(32*n)
+    //where n is the number of limbs m takes up
+    struct montgomery {
+      std::array<limb, num_limbs> m, one, minus_one, r2;
+      int n;
+      limb minv;
+
+      explicit montgomery(const limb *mod) noexcept {
+	LimbKernels::copy(m.data(), mod, num_limbs);
+	n = LimbKernels::size(mod, num_limbs);
+	minv = LimbKernels::inverse_limb(m[0]);
+	std::vector<limb> pw(2*n+1, 0);
+	pw[n] = 1;
+	LimbKernels::zero(one.data(), num_limbs);
+	LimbKernels::divmod(nullptr, one.data(), pw.data(), n+1, m.data(), n);
+	pw[n] = 0;
+	pw[2*n] = 1;
+	LimbKernels::zero(r2.data(), num_limbs);
+	LimbKernels::divmod(nullptr, r2.data(), pw.data(), 2*n+1, m.data(), n);
+	LimbKernels::zero(minus_one.data(), num_limbs);
+	LimbKernels::sub_n(minus_one.data(), m.data(), one.data(), n);
+      }
+
+      //r = a*b/R mod m; r may alias a or b
+      void mul(limb *r, const limb *a, const limb *b) const noexcept {
+	std::array<limb, num_limbs+2> t = {};
+	for(int i = 0; i < n; i++) {
+	  wide carry = 0;
+	  for(int j = 0; j < n; j++) {
+	    carry += (wide)a[j] * b[i] + t[j];
+	    t[j] = (limb)carry;
+	    carry >>= LimbKernels::limb_bits;
+	  }
+	  carry += t[n];
+	  t[n] = (limb)carry;
+	  t[n+1] = (limb)(carry >> LimbKernels::limb_bits);
+	  limb q = t[0] * minv;
+	  carry = ((wide)q * m[0] + t[0]) >> LimbKernels::limb_bits;
+	  for(int j = 1; j < n; j++) {
+	    carry += (wide)q * m[j] + t[j];
+	    t[j-1] = (limb)carry;
+	    carry >>= LimbKernels::limb_bits;
+	  }
+	  carry += t[n];
+	  t[n-1] = (limb)carry;
+	  t[n] = t[n+1] + (limb)(carry >> LimbKernels::limb_bits);
 	}
-	return;
+	if(t[n] || LimbKernels::cmp(t.data(), n, m.data(), n) >= 0) {
+	  LimbKernels::sub_n(t.data(), t.data(), m.data(), n);
+	}
+	LimbKernels::copy(r, t.data(), n);
       }
-      int is_sign = 0;
-      if((value[0] == '+') || (value[0] == '-')) is_sign = 1;
-      if((int)value.length() == is_sign) {
-	for(int i = 0; i < N/CHAR_BIT; i++) {
-	  bitmap[i] = 0;
+
+      //into Montgomery form; a must already be less than m
+      void to(limb *r, const limb *a) const noexcept {
+	mul(r, a, r2.data());
+      }
+
+      void add(limb *r, const limb *a, const limb *b) const noexcept {
+	limb carry = LimbKernels::add_n(r, a, b, n);
+	if(carry || LimbKernels::cmp(r, n, m.data(), n) >= 0) LimbKernels::sub_n(r, r, m.data(), n);
+      }
+
+      void sub(limb *r, const limb *a, const limb *b) const noexcept {
+	if(LimbKernels::sub_n(r, a, b, n)) LimbKernels::add_n(r, r, m.data(), n);
+      }
+
+      //r = a/2 mod m
+      void half(limb *r, const limb *a) const noexcept {
+	limb carry = 0;
+	if(a[0] & 1) carry = LimbKernels::add_n(r, a, m.data(), n);
+	else LimbKernels::copy(r, a, n);
+	LimbKernels::shr(r, n, 1);
+	r[n-1] |= carry << (LimbKernels::limb_bits-1);
+      }
+
+      bool equal(const limb *a, const limb *b) const noexcept {
+	return LimbKernels::cmp(a, n, b, n) == 0;
+      }
+
+      //r = base^e, four exponent bits at a time
+      void pow(limb *r, const limb *base, const limb *e, int en) const noexcept {
+	std::vector<limb> table(16*n);
+	LimbKernels::copy(table.data(), one.data(), n);
+	for(int i = 1; i < 16; i++) mul(table.data() + i*n, table.data() + (i-1)*n, base);
+	LimbKernels::copy(r, one.data(), n);
+	int bits = LimbKernels::bit_length(e, en);
+	for(int i = ((bits+3)/4)*4 - 4; i >= 0; i -= 4) {
+	  for(int j = 0; j < 4; j++) mul(r, r, r);
+	  int w = (int)(LimbKernels::extract_wide(e, en, i) & 15);
+	  if(w) mul(r, r, table.data() + w*n);
 	}
-	return;
       }
-      std::string remaining = value.substr(is_sign);
-      int counter = 1;
-      div_by_byte_data dbbd;
-      while(remaining.length() > 0) {
-        dbbd = divide_by_byte(remaining, base);
-	bitmap[N/CHAR_BIT-counter] = dbbd.remainder;
-	remaining = dbbd.quotient;
-	counter++;
+    };
+
+    //how many of the small primes is_probable_prime divides by first
+    static constexpr int trial_division_primes = 256;
+
+    //strong probable-prime test to the given base (Miller-Rabin)
+    static bool miller_rabin(const montgomery &mont, limb base) noexcept {
+      const int n = mont.n;
+      std::array<limb, num_limbs> d, b, x;
+      LimbKernels::sub_1(d.data(), mont.m.data(), n, 1);
+      int s = LimbKernels::trailing_zeros(d.data(), n);
+      LimbKernels::shr(d.data(), n, s);
+      LimbKernels::zero(b.data(), n);
+      b[0] = base;
+      mont.to(b.data(), b.data());
+      mont.pow(x.data(), b.data(), d.data(), n);
+      if(mont.equal(x.data(), mont.one.data()) || mont.equal(x.data(), mont.minus_one.data())) return true;
+      for(int i = 1; i < s; i++) {
+	mont.mul(x.data(), x.data(), x.data());
+	if(mont.equal(x.data(), mont.minus_one.data())) return true;
+	if(mont.equal(x.data(), mont.one.data())) return false;
       }
-      if(is_sign && (value[0] == '-')) {
-	*this = -(*this);
+      return false;
+    }
+
+    //Jacobi symbol (d/m) for a small d and an odd magnitude m
+    static int jacobi(long d, const limb *m, int n) noexcept {
+      int ret = 1;
+      if(d < 0) {
+	d = -d;
+	if((m[0] & 3) == 3) ret = -ret;
       }
+      while(d > 0 && !(d & 1)) {
+	d >>= 1;
+	if((m[0] & 7) == 3 || (m[0] & 7) == 5) ret = -ret;
+      }
+      if(d == 1) return ret;
+      if((d & 3) == 3 && (m[0] & 3) == 3) ret = -ret;
+      limb rem = LimbKernels::divmod_1(nullptr, m, n, (limb)d);
+      return ret * LimbKernels::jacobi_wide(rem, (wide)d);
     }
 
-    //get the most significant byte that is not equal to 0
-    //return -1 if the number is equal to 0
-    int msb() {
-      for(int i = 0; i < N/CHAR_BIT; i++) {
-	if(bitmap[i] != 0) {
-	  return N/CHAR_BIT-i-1;
+    //strong Lucas probable-prime test with Selfridge's parameters
+    //(P = 1, Q = (1-D)/4 for the first D in 5, -7, 9, ... with (D/m) = -1)
+    static bool strong_lucas(const montgomery &mont) noexcept {
+      const int n = mont.n;
+      const limb *m = mont.m.data();
+      long d = 5;
+      int tries = 0;
+      while(true) {
+	int j = jacobi(d, m, n);
+	if(j == -1) break;
+	if(j == 0) return false;
+	//no such D exists for perfect squares
+	if(++tries == 8) {
+	  std::array<limb, num_limbs> r, sq, mm = {};
+	  LimbKernels::copy(mm.data(), m, n);
+	  root_magnitude(r.data(), mm.data(), 2);
+	  std::array<limb, 2*num_limbs> prod;
+	  LimbKernels::mul(prod.data(), r.data(), num_limbs, r.data(), num_limbs);
+	  LimbKernels::copy(sq.data(), prod.data(), num_limbs);
+	  if(LimbKernels::cmp(sq.data(), num_limbs, mm.data(), num_limbs) == 0) return false;
 	}
+	d = (d > 0) ? -(d+2) : -(d-2);
       }
-      return -1;
+      //D and Q in Montgomery form
+      std::array<limb, num_limbs> dm, qm, tmp;
+      long q = (1 - d) / 4;
+      LimbKernels::zero(tmp.data(), n);
+      tmp[0] = (limb)(d < 0 ? -d : d);
+      mont.to(dm.data(), tmp.data());
+      LimbKernels::zero(tmp.data(), n);
+      if(d < 0) {
+	mont.sub(dm.data(), tmp.data(), dm.data());
+      }
+      tmp[0] = (limb)(q < 0 ? -q : q);
+      mont.to(qm.data(), tmp.data());
+      if(q < 0) {
+	LimbKernels::zero(tmp.data(), n);
+	mont.sub(qm.data(), tmp.data(), qm.data());
+      }
+      //m+1 = k * 2^s with k odd
+      std::array<limb, num_limbs+1> k;
+      k[num_limbs] = LimbKernels::add_1(k.data(), mont.m.data(), num_limbs, 1);
+      int s = LimbKernels::trailing_zeros(k.data(), num_limbs+1);
+      LimbKernels::shr(k.data(), num_limbs+1, s);
+      //U_1 = 1, V_1 = P = 1, Q^1 = Q, then walk down the bits of k
+      std::array<limb, num_limbs> u, v, qk, t;
+      u = mont.one;
+      v = mont.one;
+      qk = qm;
+      for(int i = LimbKernels::bit_length(k.data(), num_limbs+1) - 2; i >= 0; i--) {
+	//double: U_2j = U_j V_j, V_2j = V_j^2 - 2Q^j
+	mont.mul(u.data(), u.data(), v.data());
+	mont.mul(v.data(), v.data(), v.data());
+	mont.sub(v.data(), v.data(), qk.data());
+	mont.sub(v.data(), v.data(), qk.data());
+	mont.mul(qk.data(), qk.data(), qk.data());
+	if(LimbKernels::test_bit(k.data(), num_limbs+1, i)) {
+	  //step: U_j+1 = (U_j + V_j)/2, V_j+1 = (D U_j + V_j)/2
+	  mont.mul(t.data(), dm.data(), u.data());
+	  mont.add(u.data(), u.data(), v.data());
+	  mont.half(u.data(), u.data());
+	  mont.add(v.data(), t.data(), v.data());
+	  mont.half(v.data(), v.data());
+	  mont.mul(qk.data(), qk.data(), qm.data());
+	}
+      }
+      if(LimbKernels::is_zero(u.data(), n)) return true;
+      for(int r = 0; r < s; r++) {
+	if(LimbKernels::is_zero(v.data(), n)) return true;
+	mont.mul(v.data(), v.data(), v.data());
+	mont.sub(v.data(), v.data(), qk.data());
+	mont.sub(v.data(), v.data(), qk.data());
+	mont.mul(qk.data(), qk.data(), qk.data());
+      }
+      return false;
     }
-    
-    //store the data
-    unsigned char bitmap[N/CHAR_BIT];
-    
+
+    //Baillie-PSW on an odd magnitude with no small factors, plus extra
+    //Miller-Rabin rounds to small prime bases
+    static bool probable_prime_magnitude(const limb *a, int rounds) noexcept {
+      montgomery mont(a);
+      if(!miller_rabin(mont, 2)) return false;
+      if(!strong_lucas(mont)) return false;
+      const std::vector<limb> &p = SmallPrimes::primes();
+      for(int i = 0; i < rounds && i < (int)p.size(); i++) {
+	if(!miller_rabin(mont, p[i])) return false;
+      }
+      return true;
+    }
+
+    //trial division, then the probable-prime tests if that wasn't enough
+    static bool is_prime_magnitude(const limb *a, int rounds) noexcept {
+      const std::vector<limb> &p = SmallPrimes::primes();
+      const limb largest = p[trial_division_primes-1];
+      if(LimbKernels::size(a, num_limbs) <= 1 && a[0] <= largest) {
+	if(a[0] == 2) return true;
+	return std::binary_search(p.begin(), p.begin() + trial_division_primes, a[0]);
+      }
+      if(!(a[0] & 1)) return false;
+      std::array<limb, trial_division_primes> rem;
+      SmallPrimes::residues(rem.data(), a, num_limbs, trial_division_primes);
+      for(int i = 0; i < trial_division_primes; i++) {
+	if(rem[i] == 0) return false;
+      }
+      if(LimbKernels::bit_length(a, num_limbs) <= 2*LimbKernels::limb_bits &&
+	 LimbKernels::get_wide(a, num_limbs) < (wide)largest * largest) return true;
+      return probable_prime_magnitude(a, rounds);
+    }
+
+    //smallest probable prime >= start whose magnitude is below limit bits.
+    //Candidates are sieved a window at a time against the small primes, and
+    //the residues carried from one window to the next, so only survivors
+    //pay for a Miller-Rabin test. Returns false if it ran past limit.
+    static bool sieve_prime_magnitude(limb *start, int limit, int rounds) noexcept {
+      //small starting points just get tested one at a time
+      if(LimbKernels::bit_length(start, num_limbs) <= LimbKernels::limb_bits/2) {
+	while(!is_prime_magnitude(start, rounds)) {
+	  LimbKernels::add_1(start, start, num_limbs, 1);
+	}
+	return LimbKernels::bit_length(start, num_limbs) <= limit;
+      }
+      if(!(start[0] & 1)) LimbKernels::add_1(start, start, num_limbs, 1);
+      const std::vector<limb> &p = SmallPrimes::primes();
+      int bits = LimbKernels::bit_length(start, num_limbs);
+      //sieve deeper for bigger numbers, where each test costs more
+      int count = (int)p.size();
+      if(bits*bits/2 < (int)p[count-1]) {
+	count = (int)(std::upper_bound(p.begin(), p.end(), (limb)(bits*bits/2)) - p.begin());
+	if(count < trial_division_primes) count = trial_division_primes;
+      }
+      //the window holds the odd numbers start, start+2, ..., start+2*(width-1)
+      const int width = 4*bits;
+      std::vector<limb> rem(count);
+      SmallPrimes::residues(rem.data(), start, num_limbs, count);
+      std::vector<bool> composite(width);
+      while(true) {
+	std::fill(composite.begin(), composite.end(), false);
+	for(int i = 0; i < count; i++) {
+	  //first j with start + 2j == 0 mod p[i]
+	  limb first = (limb)(((wide)(p[i] - rem[i]) % p[i] * ((p[i]+1)/2)) % p[i]);
+	  for(limb j = first; j < (limb)width; j += p[i]) composite[j] = true;
+	}
+	for(int j = 0; j < width; j++) {
+	  if(composite[j]) continue;
+	  std::array<limb, num_limbs> cand;
+	  LimbKernels::copy(cand.data(), start, num_limbs);
+	  LimbKernels::add_1(cand.data(), cand.data(), num_limbs, (limb)(2*j));
+	  if(LimbKernels::bit_length(cand.data(), num_limbs) > limit) return false;
+	  if(probable_prime_magnitude(cand.data(), rounds)) {
+	    LimbKernels::copy(start, cand.data(), num_limbs);
+	    return true;
+	  }
+	}
+	LimbKernels::add_1(start, start, num_limbs, (limb)(2*width));
+	if(LimbKernels::bit_length(start, num_limbs) > limit) return false;
+	for(int i = 0; i < count; i++) rem[i] = (limb)((rem[i] + (wide)2*width) % p[i]);
+      }
+    }
+
+    //fill limbs with uniform random bits. Generators that produce a whole
+    //number of limbs per call (mt19937, mt19937_64, random_device, ...) are
+    //used as they are; anything else goes through uniform_int_distribution.
+    template<typename URBG>
+    static void random_limbs(limb *dst, int n, URBG &gen) {
+      const wide range = (wide)(URBG::max() - URBG::min());
+      const bool all_ones = (range & (range + 1)) == 0;
+      if(all_ones && range == ~(wide)0) {
+	for(int i = 0; i < n; i += 2) {
+	  wide w = (wide)(gen() - URBG::min());
+	  dst[i] = (limb)w;
+	  if(i+1 < n) dst[i+1] = (limb)(w >> LimbKernels::limb_bits);
+	}
+      }
+      else if(all_ones && range >= (limb)~(limb)0) {
+	for(int i = 0; i < n; i++) dst[i] = (limb)(gen() - URBG::min());
+      }
+      else {
+	std::uniform_int_distribution<limb> dist;
+	for(int i = 0; i < n; i++) dst[i] = dist(gen);
+      }
+    }
+
+    //uniform in [0, bound) by rejection: draw only as many bits as
+    //bound-1 has, so at least half the draws are kept
+    template<typename URBG>
+    static void random_below_limbs(limb *r, const limb *bound, int n, URBG &gen) {
+      std::vector<limb> top(bound, bound + n);
+      LimbKernels::sub_1(top.data(), top.data(), n, 1);
+      int bits = LimbKernels::bit_length(top.data(), n);
+      int used = (bits + LimbKernels::limb_bits - 1) / LimbKernels::limb_bits;
+      LimbKernels::zero(r, n);
+      if(bits == 0) return;
+      do {
+	random_limbs(r, used, gen);
+	LimbKernels::mask_bits(r, used, bits);
+      } while(LimbKernels::cmp(r, used, top.data(), n) > 0);
+    }
+
+    //the two's-complement bits, sign extended to n >= num_limbs limbs
+    void to_limbs_signed(limb *dst, int n) const noexcept {
+      LimbKernels::from_bytes(dst, n, bitmap, N/CHAR_BIT);
+      if(sign()) return;
+      for(int i = N; i < n*LimbKernels::limb_bits; i++) {
+	dst[i/LimbKernels::limb_bits] |= (limb)1 << (i%LimbKernels::limb_bits);
+      }
+    }
+
   public:
     template<int M>
     friend class alexstrong::big_int;
+    template<int M>
+    friend class alexstrong::big_uint;
+    friend class big_int_parser<N>;
+    friend class big_int_formatter<N>;
+    template<int M>
+    friend class alexstrong::big_int_accumulator;
+    template<int M>
+    friend class alexstrong::big_int_sorter;
+    template<int M>
+    friend class alexstrong::rns_int;
     
     //static stuff, stores info about the size
     static constexpr int num_bits = N;
@@ -259,15 +1323,9 @@ namespace alexstrong {
       parse(value, base);
     }
 
-    //copy constructor
-    big_int(const big_int<N> &other) noexcept {
-      //if(DEBUG) std::cerr << "other's int value is " << other.to_int() << std::endl;
-      if(DEBUG) std::cerr << "There are " << N/CHAR_BIT << " bytes in this number." << std::endl;
-      for(int i = 0; i < N/CHAR_BIT; i++) {
-	if(DEBUG) std::cerr << "\tcopy constructor loop: i = " << i << std::endl;
-	bitmap[i] = other.bitmap[i];
-      }
-    }
+    //copy and move are plain byte copies, so big_int stays trivially
+    //copyable and arrays of it can be written out or mapped in as they are
+    big_int(const big_int<N> &other) noexcept = default;
 
     //beware of using this; could easily use information!
     template<int M>
@@ -290,26 +1348,14 @@ namespace alexstrong {
       }
     }
 
-    //move constructor
-    big_int(big_int<N> &&other) noexcept {
-      for(int i = 0; i < N/CHAR_BIT; i++) {
-	bitmap[i] = other.bitmap[i];
-	other.bitmap[i] = 0;
-      }
-    }
+    big_int(big_int<N> &&other) noexcept = default;
 
     //destructor
     //~big_int() {
       //do nothing, no pointers to free/delete
     //}
 
-    //copy assignment
-    big_int &operator=(const big_int &other) noexcept {
-      for(int i = 0; i < N/CHAR_BIT; i++) {
-	bitmap[i] = other.bitmap[i];
-      }
-      return *this;
-    }
+    big_int &operator=(const big_int &other) noexcept = default;
 
     //beware of using this; could easily lose information!
     template<int M>
@@ -323,20 +1369,13 @@ namespace alexstrong {
 	  bitmap[0] ^= 1 << (CHAR_BIT-1);
 	}
       }
-      for(int i = IntUtils<M, N>::min+1; i <= N; i++) {
-	bitmap[N-i] = (!(other.sign())) * byte_mask;
+      for(int i = IntUtils<M, N>::min/CHAR_BIT+1; i <= N/CHAR_BIT; i++) {
+	bitmap[N/CHAR_BIT-i] = (!(other.sign())) * byte_mask;
       }
       return *this;
     }
 
-    //move assignment
-    big_int<N> &operator=(big_int<N> &&other) noexcept {
-      for(int i = 0; i < N/CHAR_BIT; i++) {
-	bitmap[i] = other.bitmap[i];
-	other.bitmap[i] = 0;
-      }
-      return *this;
-    }
+    big_int<N> &operator=(big_int<N> &&other) noexcept = default;
 
     //bitwise not
     big_int<N> operator~() const noexcept {
@@ -438,6 +1477,17 @@ namespace alexstrong {
       return !(bitmap[0] & mask);
     }
 
+    //-1, 0 or 1 as this is less than, equal to or greater than other.
+    //same-sign two's complement orders like unsigned, so this is a plain
+    //byte compare with no copies
+    int compare(const big_int<N> &other) const noexcept {
+      if(sign() != other.sign()) return sign() ? 1 : -1;
+      for(int i = 0; i < N/CHAR_BIT; i++) {
+	if(bitmap[i] != other.bitmap[i]) return bitmap[i] < other.bitmap[i] ? -1 : 1;
+      }
+      return 0;
+    }
+
     big_int<N> abs() const noexcept {
       if(sign()) return *this;
       return -(*this);
@@ -598,34 +1648,20 @@ namespace alexstrong {
     }
 
     //get string representation in any base <= 36
-    std::string to_base(int base) {
-      assert(base <= 36 && base > 1);
-      big_int<sizeof(int)*CHAR_BIT> base_big_int(base);
-      std::string ret = "";
-      const big_int<N> ZERO;
-      big_int<N> copy(*this);
-      if(!sign()) copy = -copy;
-      if(DEBUG) std::cerr << "copy, as int, is " << copy.to_int() << std::endl;
-      while(copy != ZERO) {
-        auto div_data = copy.divide(base_big_int);
-	big_int<N> quotient = div_data.quotient;
-	if(DEBUG) std::cerr << "quotient, as int, is " << quotient.to_int() << std::endl;
-        int remainder = div_data.remainder.to_int();
-	if(DEBUG) std::cerr << "remainder is " << remainder << std::endl;
-	char next_digit = uppercase_digits[remainder];
-	if(DEBUG) std::cerr << "next digit is " << next_digit << std::endl;
-	ret.insert(ret.begin(), next_digit);
-	if(DEBUG) std::cerr << "ret is " << ret << std::endl;
-	copy = quotient;
-	if(DEBUG) std::cerr << "copy, as int, is " << copy.to_int() << std::endl;
-      }
-      if(!sign()) ret.insert(0, "-");
-      return ret;
-    }
-
-    //output
-    friend std::ostream &operator<<(std::ostream &os, big_int<N> num) {
-      os << num.to_base(10);
+    std::string to_base(int base) const {
+      big_int_formatter<N> formatter(*this, base);
+      std::string ret(formatter.length(), '0');
+      formatter.read(&ret[0], ret.length());
+      return ret;
+    }
+
+    //output; std::hex and std::oct pick the base, and std::setw, std::setfill
+    //and the adjustment flags pad as usual. Digits are always uppercase and
+    //std::showbase, std::showpos and std::uppercase are ignored.
+    friend std::ostream &operator<<(std::ostream &os, const big_int<N> &num) {
+      std::ios_base::fmtflags basefield = os.flags() & std::ios_base::basefield;
+      int base = basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+      big_int_formatter<N>(num, base).write(os);
       return os;
     }
 
@@ -844,8 +1880,660 @@ namespace alexstrong {
       ret <<= other;
       return ret;
     }
+
+    //result of the extended Euclidean algorithm: gcd == x*a + y*b
+    struct xgcd_data {
+      big_int<N> gcd;
+      big_int<N> x;
+      big_int<N> y;
+    };
+
+    //greatest common divisor, never negative
+    big_int<N> gcd(const big_int<N> &other) const noexcept {
+      std::array<limb, num_limbs> u, v;
+      to_magnitude(u.data());
+      other.to_magnitude(v.data());
+      if(LimbKernels::cmp(u.data(), num_limbs, v.data(), num_limbs) < 0) std::swap(u, v);
+      int steps;
+      lehmer(u.data(), v.data(), nullptr, nullptr, steps);
+      return from_magnitude(u.data(), num_limbs, false);
+    }
+
+    //least common multiple, never negative; wraps around if it needs more than N bits
+    big_int<N> lcm(const big_int<N> &other) const noexcept {
+      std::array<limb, num_limbs> a, b, u, v, quot;
+      to_magnitude(a.data());
+      other.to_magnitude(b.data());
+      if(LimbKernels::is_zero(a.data(), num_limbs) || LimbKernels::is_zero(b.data(), num_limbs)) {
+	return big_int<N>();
+      }
+      u = a;
+      v = b;
+      if(LimbKernels::cmp(u.data(), num_limbs, v.data(), num_limbs) < 0) std::swap(u, v);
+      int steps;
+      lehmer(u.data(), v.data(), nullptr, nullptr, steps);
+      LimbKernels::divmod(quot.data(), nullptr, a.data(), num_limbs, u.data(), num_limbs);
+      std::array<limb, 2*num_limbs> prod;
+      LimbKernels::mul(prod.data(), quot.data(), num_limbs, b.data(), num_limbs);
+      return from_magnitude(prod.data(), 2*num_limbs, false);
+    }
+
+    //extended gcd: also finds x and y with x*(*this) + y*other == gcd
+    xgcd_data xgcd(const big_int<N> &other) const noexcept {
+      xgcd_data ret;
+      const limb one = 1;
+      std::array<limb, num_limbs> a, b, u, v, su, sv;
+      bool neg_a = to_magnitude(a.data());
+      bool neg_b = other.to_magnitude(b.data());
+      if(LimbKernels::is_zero(a.data(), num_limbs)) {
+	ret.gcd = from_magnitude(b.data(), num_limbs, false);
+	if(!LimbKernels::is_zero(b.data(), num_limbs)) ret.y = from_magnitude(&one, 1, neg_b);
+	return ret;
+      }
+      if(LimbKernels::is_zero(b.data(), num_limbs)) {
+	ret.gcd = from_magnitude(a.data(), num_limbs, false);
+	if(!LimbKernels::is_zero(a.data(), num_limbs)) ret.x = from_magnitude(&one, 1, neg_a);
+	return ret;
+      }
+      bool swapped = LimbKernels::cmp(a.data(), num_limbs, b.data(), num_limbs) < 0;
+      if(swapped) {
+	std::swap(a, b);
+	std::swap(neg_a, neg_b);
+      }
+      u = a;
+      v = b;
+      LimbKernels::set_wide(su.data(), num_limbs, 1);
+      LimbKernels::zero(sv.data(), num_limbs);
+      int steps;
+      lehmer(u.data(), v.data(), su.data(), sv.data(), steps);
+      //u == s*a + t*b where s = (-1)^steps * su, so t = (u - s*a) / b
+      bool s_neg = (steps & 1) && !LimbKernels::is_zero(su.data(), num_limbs);
+      std::array<limb, 2*num_limbs> num;
+      std::array<limb, 2*num_limbs> t;
+      LimbKernels::mul(num.data(), a.data(), num_limbs, su.data(), num_limbs);
+      bool t_neg = !s_neg && !LimbKernels::is_zero(su.data(), num_limbs);
+      if(t_neg) LimbKernels::sub(num.data(), num.data(), 2*num_limbs, u.data(), num_limbs);
+      else LimbKernels::add(num.data(), num.data(), 2*num_limbs, u.data(), num_limbs);
+      LimbKernels::divmod(t.data(), nullptr, num.data(), 2*num_limbs, b.data(), num_limbs);
+      ret.gcd = from_magnitude(u.data(), num_limbs, false);
+      big_int<N> s_val = from_magnitude(su.data(), num_limbs, s_neg != neg_a);
+      big_int<N> t_val = from_magnitude(t.data(), 2*num_limbs, t_neg != neg_b);
+      ret.x = swapped ? t_val : s_val;
+      ret.y = swapped ? s_val : t_val;
+      return ret;
+    }
+
+    //multiplicative inverse modulo |modulus|, in [0, |modulus|)
+    //returns 0 if there isn't one
+    big_int<N> mod_inverse(const big_int<N> &modulus) const noexcept {
+      std::array<limb, num_limbs> a, m, u, v, su, sv;
+      bool neg = to_magnitude(a.data());
+      modulus.to_magnitude(m.data());
+      if(LimbKernels::bit_length(m.data(), num_limbs) <= 1) return big_int<N>();
+      LimbKernels::divmod(nullptr, v.data(), a.data(), num_limbs, m.data(), num_limbs);
+      if(neg && !LimbKernels::is_zero(v.data(), num_limbs)) {
+	LimbKernels::sub_n(v.data(), m.data(), v.data(), num_limbs);
+      }
+      //follow the coefficient of v, which starts out as 0*u + 1*v
+      u = m;
+      LimbKernels::zero(su.data(), num_limbs);
+      LimbKernels::set_wide(sv.data(), num_limbs, 1);
+      int steps;
+      lehmer(u.data(), v.data(), su.data(), sv.data(), steps);
+      if(LimbKernels::bit_length(u.data(), num_limbs) != 1) return big_int<N>();
+      //that coefficient is negative after an even number of steps
+      if(!(steps & 1) && !LimbKernels::is_zero(su.data(), num_limbs)) {
+	LimbKernels::sub_n(su.data(), m.data(), su.data(), num_limbs);
+      }
+      return from_magnitude(su.data(), num_limbs, false);
+    }
+
+    //the N/CHAR_BIT bytes of the two's-complement bits. Big-endian is the
+    //order big_int keeps them in, so that way round it's a plain copy.
+    void export_bytes(unsigned char *dst, byte_order order = byte_order::big_endian) const noexcept {
+      for(int i = 0; i < N/CHAR_BIT; i++) {
+	dst[i] = (order == byte_order::big_endian) ? bitmap[i] : bitmap[N/CHAR_BIT-1-i];
+      }
+    }
+
+    static big_int<N> import_bytes(const unsigned char *src, byte_order order = byte_order::big_endian) noexcept {
+      big_int<N> ret;
+      for(int i = 0; i < N/CHAR_BIT; i++) {
+	ret.bitmap[i] = (order == byte_order::big_endian) ? src[i] : src[N/CHAR_BIT-1-i];
+      }
+      return ret;
+    }
+
+    //number of bits in the magnitude, 0 for 0
+    int bit_length() const noexcept {
+      std::array<limb, num_limbs> a;
+      to_magnitude(a.data());
+      return LimbKernels::bit_length(a.data(), num_limbs);
+    }
+
+    //result of isqrt_rem: root*root + remainder == the original number
+    struct isqrt_data {
+      big_int<N> root;
+      big_int<N> remainder;
+    };
+
+    //floor of the square root; the number must not be negative
+    big_int<N> isqrt() const noexcept {
+      return iroot(2);
+    }
+
+    isqrt_data isqrt_rem() const noexcept {
+      assert(sign());
+      isqrt_data ret;
+      std::array<limb, num_limbs> a, r;
+      std::array<limb, 2*num_limbs> sq;
+      to_magnitude(a.data());
+      root_magnitude(r.data(), a.data(), 2);
+      LimbKernels::mul(sq.data(), r.data(), num_limbs, r.data(), num_limbs);
+      LimbKernels::sub_n(a.data(), a.data(), sq.data(), num_limbs);
+      ret.root = from_magnitude(r.data(), num_limbs, false);
+      ret.remainder = from_magnitude(a.data(), num_limbs, false);
+      return ret;
+    }
+
+    //k-th root, rounded toward 0; negative numbers need an odd k
+    big_int<N> iroot(int k) const noexcept {
+      assert(k >= 1);
+      std::array<limb, num_limbs> a, r;
+      bool neg = to_magnitude(a.data());
+      assert(!neg || (k & 1));
+      root_magnitude(r.data(), a.data(), k);
+      return from_magnitude(r.data(), num_limbs, neg);
+    }
+
+    //true if this is base^exponent for some exponent >= 2, which is
+    //reported as the smallest such prime
+    bool is_perfect_power(big_int<N> &base, int &exponent) const noexcept {
+      std::array<limb, num_limbs> a, r;
+      bool neg = to_magnitude(a.data());
+      int bits = LimbKernels::bit_length(a.data(), num_limbs);
+      if(bits <= 1) {
+	base = *this;
+	exponent = neg ? 3 : 2;
+	return true;
+      }
+      std::vector<limb> pw(num_limbs);
+      int n = LimbKernels::size(a.data(), num_limbs);
+      int zeros = LimbKernels::trailing_zeros(a.data(), num_limbs);
+      for(int k = (neg ? 3 : 2); k <= bits; k++) {
+	if(!may_be_power(a.data(), n, zeros, k)) continue;
+	root_magnitude(r.data(), a.data(), k);
+	if(pow_capped(pw, r.data(), k, bits) && LimbKernels::cmp(pw.data(), num_limbs, a.data(), num_limbs) == 0) {
+	  base = from_magnitude(r.data(), num_limbs, neg);
+	  exponent = k;
+	  return true;
+	}
+      }
+      return false;
+    }
+
+    bool is_perfect_power() const noexcept {
+      big_int<N> base;
+      int exponent;
+      return is_perfect_power(base, exponent);
+    }
+
+    //how many exponents is_perfect_power would take a root for, i.e. the
+    //primes k that get past the cheap filters
+    int perfect_power_candidates() const noexcept {
+      std::array<limb, num_limbs> a;
+      bool neg = to_magnitude(a.data());
+      int bits = LimbKernels::bit_length(a.data(), num_limbs);
+      if(bits <= 1) return 0;
+      int n = LimbKernels::size(a.data(), num_limbs);
+      int zeros = LimbKernels::trailing_zeros(a.data(), num_limbs);
+      int ret = 0;
+      for(int k = (neg ? 3 : 2); k <= bits; k++) {
+	if(may_be_power(a.data(), n, zeros, k)) ret++;
+      }
+      return ret;
+    }
+
+    //trial division by small primes, then Baillie-PSW (a base-2 Miller-Rabin
+    //test and a strong Lucas test), then rounds more Miller-Rabin tests
+    bool is_probable_prime(int rounds = 2) const noexcept {
+      std::array<limb, num_limbs> a;
+      if(to_magnitude(a.data())) return false;
+      return is_prime_magnitude(a.data(), rounds);
+    }
+
+    //smallest probable prime greater than this, or 0 if it doesn't fit
+    big_int<N> next_prime(int rounds = 2) const noexcept {
+      std::array<limb, num_limbs> a;
+      if(to_magnitude(a.data())) {
+	LimbKernels::set_wide(a.data(), num_limbs, 2);
+      }
+      else {
+	LimbKernels::add_1(a.data(), a.data(), num_limbs, 1);
+      }
+      if(!sieve_prime_magnitude(a.data(), N-1, rounds)) return big_int<N>();
+      return from_magnitude(a.data(), num_limbs, false);
+    }
+
+    //a random probable prime with exactly the given number of bits
+    template<typename URBG>
+    static big_int<N> random_prime(int bits, URBG &gen, int rounds = 2) {
+      assert(bits >= 2 && bits < N);
+      std::array<limb, num_limbs> a;
+      do {
+	random_limbs(a.data(), num_limbs, gen);
+	LimbKernels::mask_bits(a.data(), num_limbs, bits);
+	a[(bits-1)/LimbKernels::limb_bits] |= (limb)1 << ((bits-1)%LimbKernels::limb_bits);
+      } while(!sieve_prime_magnitude(a.data(), bits, rounds));
+      return from_magnitude(a.data(), num_limbs, false);
+    }
+
+    //uniformly random over all 2^N bit patterns, so it may be negative
+    template<typename URBG>
+    static big_int<N> random_bits(URBG &gen) {
+      std::array<limb, num_limbs> a;
+      random_limbs(a.data(), num_limbs, gen);
+      return from_magnitude(a.data(), num_limbs, false);
+    }
+
+    //uniformly random in [0, 2^bits)
+    template<typename URBG>
+    static big_int<N> random_bits(int bits, URBG &gen) {
+      assert(bits >= 0 && bits < N);
+      std::array<limb, num_limbs> a = {};
+      random_limbs(a.data(), (bits + LimbKernels::limb_bits - 1) / LimbKernels::limb_bits, gen);
+      LimbKernels::mask_bits(a.data(), num_limbs, bits);
+      return from_magnitude(a.data(), num_limbs, false);
+    }
+
+    //uniformly random in [0, bound); bound must be positive
+    template<typename URBG>
+    static big_int<N> random_below(const big_int<N> &bound, URBG &gen) {
+      std::array<limb, num_limbs> b, r;
+      bool neg = bound.to_magnitude(b.data());
+      assert(!neg && !LimbKernels::is_zero(b.data(), num_limbs));
+      (void)neg;
+      random_below_limbs(r.data(), b.data(), num_limbs, gen);
+      return from_magnitude(r.data(), num_limbs, false);
+    }
+
+    //uniformly random in [lo, hi], inclusive like uniform_int_distribution
+    template<typename URBG>
+    static big_int<N> random_range(const big_int<N> &lo, const big_int<N> &hi, URBG &gen) {
+      //one spare limb, since hi - lo + 1 can take N+1 bits
+      std::array<limb, num_limbs+1> l, width, r;
+      lo.to_limbs_signed(l.data(), num_limbs+1);
+      hi.to_limbs_signed(width.data(), num_limbs+1);
+      LimbKernels::sub_n(width.data(), width.data(), l.data(), num_limbs+1);
+      assert(!(width[num_limbs] >> (LimbKernels::limb_bits-1)));
+      LimbKernels::add_1(width.data(), width.data(), num_limbs+1, 1);
+      random_below_limbs(r.data(), width.data(), num_limbs+1, gen);
+      LimbKernels::add_n(r.data(), r.data(), l.data(), num_limbs+1);
+      return from_magnitude(r.data(), num_limbs+1, false);
+    }
     
   };
+
+  //folds digits into a big_int a chunk of text at a time, so a long number
+  //can come straight from a file or socket without a full-size string.
+  //digits are gathered into groups that fill a limb and each group costs one
+  //pass over the limbs built so far.
+  template<int N>
+  class big_int_parser {
+    typedef LimbKernels::limb limb;
+    static constexpr int num_limbs = big_int<N>::num_limbs;
+
+    std::array<limb, num_limbs> mag;
+    int used;
+    int base;
+    int group_digits;
+    limb power;
+    limb chunk;
+    limb scale;
+    bool negative;
+    bool started;
+    bool digits;
+    bool stopped;
+    //a carry out of the top limb was dropped
+    bool dropped;
+
+    //mag = mag * scale + chunk, keeping whatever fits in num_limbs
+    void flush() noexcept {
+      if(scale == 1) return;
+      limb carry = LimbKernels::mul_1(mag.data(), mag.data(), used, scale);
+      carry += LimbKernels::add_1(mag.data(), mag.data(), used, chunk);
+      if(carry && used < num_limbs) mag[used++] = carry;
+      else if(carry) dropped = true;
+      chunk = 0;
+      scale = 1;
+    }
+
+  public:
+    explicit big_int_parser(int b = 10) noexcept : base(b) {
+      assert(base <= 36 && base > 1);
+      power = LimbKernels::chunk_power(base, group_digits);
+      reset();
+    }
+
+    void reset() noexcept {
+      mag.fill(0);
+      used = 0;
+      chunk = 0;
+      scale = 1;
+      negative = false;
+      started = false;
+      digits = false;
+      stopped = false;
+      dropped = false;
+    }
+
+    //takes an optional sign and then digits, and returns how many characters
+    //were used. Once a character isn't a digit nothing more is taken.
+    std::size_t feed(const char *text, std::size_t len) noexcept {
+      std::size_t i = 0;
+      if(stopped || len == 0) return 0;
+      if(!started) {
+	started = true;
+	if(text[0] == '+' || text[0] == '-') {
+	  negative = text[0] == '-';
+	  i++;
+	}
+      }
+      for(; i < len; i++) {
+	int d = digit_value(text[i]);
+	if(d >= base) {
+	  stopped = true;
+	  break;
+	}
+	chunk = chunk*base + d;
+	scale *= base;
+	digits = true;
+	if(scale == power) flush();
+      }
+      return i;
+    }
+
+    bool has_digits() const noexcept {
+      return digits;
+    }
+
+    //true once a character that isn't a digit has been seen
+    bool done() const noexcept {
+      return stopped;
+    }
+
+    //true if the number so far is outside the range of big_int<N>, i.e.
+    //at least 2^(N-1) when positive or more than 2^(N-1) when negative
+    bool overflowed() const noexcept {
+      big_int_parser<N> copy(*this);
+      copy.flush();
+      if(copy.dropped) return true;
+      int bits = LimbKernels::bit_length(copy.mag.data(), num_limbs);
+      if(bits < N) return false;
+      if(!negative || bits > N) return true;
+      //-2^(N-1) itself still fits
+      LimbKernels::mask_bits(copy.mag.data(), num_limbs, N-1);
+      return !LimbKernels::is_zero(copy.mag.data(), num_limbs);
+    }
+
+    //the number so far, modulo 2^N
+    big_int<N> value() const noexcept {
+      big_int_parser<N> copy(*this);
+      copy.flush();
+      return big_int<N>::from_magnitude(copy.mag.data(), num_limbs, negative);
+    }
+
+    //the number so far, or the nearest of -2^(N-1) and 2^(N-1)-1 if it
+    //doesn't fit
+    big_int<N> saturated_value() const noexcept {
+      if(!overflowed()) return value();
+      std::array<limb, num_limbs> limit;
+      limit.fill(0);
+      limit[(N-1)/LimbKernels::limb_bits] = (limb)1 << ((N-1)%LimbKernels::limb_bits);
+      if(!negative) LimbKernels::sub_1(limit.data(), limit.data(), num_limbs, 1);
+      return big_int<N>::from_magnitude(limit.data(), num_limbs, negative);
+    }
+  };
+
+  //writes a big_int out a piece at a time. The magnitude is split once into
+  //limb-sized groups of digits, which is about as big as the number itself,
+  //and the text is produced from them only as it is read.
+  template<int N>
+  class big_int_formatter {
+    typedef LimbKernels::limb limb;
+    static constexpr int num_limbs = big_int<N>::num_limbs;
+
+    //least significant group first
+    std::vector<limb> groups;
+    int base;
+    int group_digits;
+    bool negative;
+    std::size_t total;
+    std::size_t consumed;
+    //characters of the group being read, and the next group to render
+    char pending[CHAR_BIT*sizeof(limb)+1];
+    int pending_len;
+    int pending_pos;
+    std::size_t next;
+
+    int render(limb group, int width) noexcept {
+      int len = 0;
+      char tmp[CHAR_BIT*sizeof(limb)];
+      do {
+	tmp[len++] = uppercase_digits[group % base];
+	group /= base;
+      } while(group);
+      while(len < width) tmp[len++] = '0';
+      for(int i = 0; i < len; i++) pending[i] = tmp[len-1-i];
+      return len;
+    }
+
+  public:
+    big_int_formatter(const big_int<N> &value, int b = 10) : base(b) {
+      assert(base <= 36 && base > 1);
+      const limb power = LimbKernels::chunk_power(base, group_digits);
+      std::array<limb, num_limbs> mag;
+      negative = value.to_magnitude(mag.data());
+      consumed = 0;
+      int used = LimbKernels::size(mag.data(), num_limbs);
+      do {
+	groups.push_back(LimbKernels::divmod_1(mag.data(), mag.data(), used, power));
+	used = LimbKernels::size(mag.data(), used);
+      } while(used);
+      next = groups.size()-1;
+      pending_len = render(groups[next], 0);
+      pending_pos = 0;
+      total = negative + pending_len + next*group_digits;
+      if(negative) {
+	for(int i = pending_len; i > 0; i--) pending[i] = pending[i-1];
+	pending[0] = '-';
+	pending_len++;
+      }
+    }
+
+    //characters in the whole string
+    std::size_t length() const noexcept {
+      return total;
+    }
+
+    //copies up to len more characters into out, returns how many
+    std::size_t read(char *out, std::size_t len) noexcept {
+      std::size_t ret = 0;
+      while(ret < len) {
+	if(pending_pos == pending_len) {
+	  if(next == 0) break;
+	  pending_len = render(groups[--next], group_digits);
+	  pending_pos = 0;
+	}
+	int n = std::min<std::size_t>(pending_len - pending_pos, len - ret);
+	std::copy(pending + pending_pos, pending + pending_pos + n, out + ret);
+	pending_pos += n;
+	ret += n;
+      }
+      consumed += ret;
+      return ret;
+    }
+
+    bool done() const noexcept {
+      return pending_pos == pending_len && next == 0;
+    }
+
+    //streams whatever is left through a small buffer, padded out to
+    //os.width() with os.fill() the way std::left, std::right and
+    //std::internal ask; the width is reset afterwards like any inserter
+    void write(std::ostream &os) {
+      std::ostream::sentry sentry(os);
+      if(!sentry) return;
+      std::size_t left = total - consumed;
+      std::size_t width = os.width() > 0 ? (std::size_t)os.width() : 0;
+      std::size_t pad = width > left ? width - left : 0;
+      std::ios_base::fmtflags adjust = os.flags() & std::ios_base::adjustfield;
+      char buffer[4096];
+      if(adjust == std::ios_base::internal && negative && consumed == 0) {
+	os.write(buffer, read(buffer, 1));
+      }
+      if(adjust != std::ios_base::left) fill(os, pad);
+      while(!done() && os) {
+	os.write(buffer, read(buffer, sizeof(buffer)));
+      }
+      if(adjust == std::ios_base::left) fill(os, pad);
+      os.width(0);
+    }
+
+  private:
+    static void fill(std::ostream &os, std::size_t n) {
+      char buffer[64];
+      std::fill(buffer, buffer + sizeof(buffer), os.fill());
+      while(n && os) {
+	std::size_t chunk = std::min(n, sizeof(buffer));
+	os.write(buffer, chunk);
+	n -= chunk;
+      }
+    }
+  };
+
+  //input; std::hex and std::oct pick the base. Reading stops at the first
+  //character that isn't a digit, which is left in the stream. A number out
+  //of range sets failbit and stores the nearest limit, like the standard
+  //extractors do.
+  template<int N>
+  std::istream &operator>>(std::istream &is, big_int<N> &num) {
+    std::istream::sentry sentry(is);
+    if(!sentry) return is;
+    std::ios_base::fmtflags basefield = is.flags() & std::ios_base::basefield;
+    int base = basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+    big_int_parser<N> parser(base);
+    std::streambuf *buf = is.rdbuf();
+    std::ios_base::iostate state = std::ios_base::goodbit;
+    while(true) {
+      int c = buf->sgetc();
+      if(c == std::char_traits<char>::eof()) {
+	state |= std::ios_base::eofbit;
+	break;
+      }
+      char ch = std::char_traits<char>::to_char_type(c);
+      if(!parser.feed(&ch, 1)) break;
+      buf->sbumpc();
+    }
+    if(parser.has_digits() && parser.overflowed()) {
+      num = parser.saturated_value();
+      state |= std::ios_base::failbit;
+    }
+    else if(parser.has_digits()) {
+      num = parser.value();
+    }
+    else {
+      num = big_int<N>();
+      state |= std::ios_base::failbit;
+    }
+    is.setstate(state);
+    return is;
+  }
+
+  template<int N>
+  big_int<N> gcd(const big_int<N> &a, const big_int<N> &b) noexcept {
+    return a.gcd(b);
+  }
+
+  template<int N>
+  big_int<N> lcm(const big_int<N> &a, const big_int<N> &b) noexcept {
+    return a.lcm(b);
+  }
+
+  template<int N>
+  typename big_int<N>::xgcd_data xgcd(const big_int<N> &a, const big_int<N> &b) noexcept {
+    return a.xgcd(b);
+  }
+
+  template<int N>
+  big_int<N> mod_inverse(const big_int<N> &a, const big_int<N> &modulus) noexcept {
+    return a.mod_inverse(modulus);
+  }
+
+  template<int N>
+  big_int<N> isqrt(const big_int<N> &a) noexcept {
+    return a.isqrt();
+  }
+
+  template<int N>
+  typename big_int<N>::isqrt_data isqrt_rem(const big_int<N> &a) noexcept {
+    return a.isqrt_rem();
+  }
+
+  template<int N>
+  big_int<N> iroot(const big_int<N> &a, int k) noexcept {
+    return a.iroot(k);
+  }
+
+  template<int N>
+  bool is_perfect_power(const big_int<N> &a) noexcept {
+    return a.is_perfect_power();
+  }
+
+  template<int N>
+  bool is_probable_prime(const big_int<N> &a, int rounds = 2) noexcept {
+    return a.is_probable_prime(rounds);
+  }
+
+  template<int N>
+  big_int<N> next_prime(const big_int<N> &a, int rounds = 2) noexcept {
+    return a.next_prime(rounds);
+  }
+
+  template<int N, typename URBG>
+  big_int<N> random_prime(int bits, URBG &gen, int rounds = 2) {
+    return big_int<N>::random_prime(bits, gen, rounds);
+  }
+
+  template<int N>
+  void export_bytes(const big_int<N> &a, unsigned char *dst, byte_order order = byte_order::big_endian) noexcept {
+    a.export_bytes(dst, order);
+  }
+
+  template<int N>
+  big_int<N> import_bytes(const unsigned char *src, byte_order order = byte_order::big_endian) noexcept {
+    return big_int<N>::import_bytes(src, order);
+  }
+
+  template<int N, typename URBG>
+  big_int<N> random_bits(URBG &gen) {
+    return big_int<N>::random_bits(gen);
+  }
+
+  template<int N, typename URBG>
+  big_int<N> random_bits(int bits, URBG &gen) {
+    return big_int<N>::random_bits(bits, gen);
+  }
+
+  template<int N, typename URBG>
+  big_int<N> random_below(const big_int<N> &bound, URBG &gen) {
+    return big_int<N>::random_below(bound, gen);
+  }
+
+  template<int N, typename URBG>
+  big_int<N> random_range(const big_int<N> &lo, const big_int<N> &hi, URBG &gen) {
+    return big_int<N>::random_range(lo, hi, gen);
+  }
 }
 
 #endif
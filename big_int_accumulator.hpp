@@ -0,0 +1,136 @@
+#include "big_int.hpp"
+#include <cstddef>
+
+#ifndef BIG_INT_ACCUMULATOR_H
+#define BIG_INT_ACCUMULATOR_H
+
+namespace alexstrong {
+
+  //Sums big_int<N> values without a carry chain per add. Each 32-bit limb of
+  //a value is added into its own 64-bit lane, so the lanes don't depend on
+  //each other and the compiler is free to vectorize. A lane can take
+  //2^32 - 1 adds before it could overflow, and the carries are only pushed
+  //up at that point or when the sum is read.
+  //
+  //Negative values are added as their two's-complement bits and counted, and
+  //value() takes 2^(32*num_limbs) off for each of them, so the sum is exact
+  //in two extra limbs and can be read back into a wider big_int.
+  template<int N>
+  class big_int_accumulator {
+    typedef LimbKernels::limb limb;
+    typedef LimbKernels::wide wide;
+
+    static constexpr int num_limbs = big_int<N>::num_limbs;
+    static constexpr int num_lanes = num_limbs+2;
+    static constexpr int num_bytes = N/CHAR_BIT;
+    static constexpr wide headroom = 0xFFFFFFFFu;
+    static constexpr wide limb_mask = 0xFFFFFFFFu;
+
+    //bits above N in the top limb, set when a negative value is sign extended
+    static constexpr limb fill = N % LimbKernels::limb_bits ? ~(limb)0 << (N % LimbKernels::limb_bits) : 0;
+
+    wide lanes[num_lanes];
+    //adds since the lanes were last normalized
+    wide pending;
+    std::uint64_t negatives;
+    std::uint64_t total;
+
+    //adds the limbs of value into a local copy of the lanes; the bytes of a
+    //big_int may alias anything, so working on the members here would make
+    //the compiler store and reload every lane for every byte
+    static wide add_to(wide *acc, const big_int<N> &value) noexcept {
+      const unsigned char *bytes = value.bitmap;
+      for(int i = 0; i < num_bytes/LimbKernels::limb_bytes; i++) {
+	const unsigned char *p = bytes + num_bytes - (i+1)*LimbKernels::limb_bytes;
+	acc[i] += (limb)p[0] << 3*CHAR_BIT | (limb)p[1] << 2*CHAR_BIT | (limb)p[2] << CHAR_BIT | p[3];
+      }
+      //a top limb that is only partly filled
+      for(int i = num_bytes/LimbKernels::limb_bytes*LimbKernels::limb_bytes; i < num_bytes; i++) {
+	acc[num_limbs-1] += (wide)bytes[num_bytes-1-i] << ((i%LimbKernels::limb_bytes)*CHAR_BIT);
+      }
+      wide negative = bytes[0] >> (CHAR_BIT-1);
+      acc[num_limbs-1] += fill & (0 - negative);
+      return negative;
+    }
+
+  public:
+    big_int_accumulator() noexcept {
+      clear();
+    }
+
+    void clear() noexcept {
+      for(int i = 0; i < num_lanes; i++) lanes[i] = 0;
+      pending = 0;
+      negatives = 0;
+      total = 0;
+    }
+
+    //number of values added so far
+    std::uint64_t count() const noexcept {
+      return total;
+    }
+
+    //pushes the carries up so every lane but the top one is below 2^32
+    void normalize() noexcept {
+      wide carry = 0;
+      for(int i = 0; i < num_lanes-1; i++) {
+	carry += lanes[i];
+	lanes[i] = carry & limb_mask;
+	carry >>= LimbKernels::limb_bits;
+      }
+      lanes[num_lanes-1] += carry;
+      pending = 0;
+    }
+
+    big_int_accumulator<N> &operator+=(const big_int<N> &value) noexcept {
+      add(&value, 1);
+      return *this;
+    }
+
+    //adds count values, normalizing only between blocks
+    void add(const big_int<N> *values, std::size_t count) noexcept {
+      total += count;
+      while(count) {
+	if(pending == headroom) normalize();
+	std::size_t block = std::min<wide>(count, headroom - pending);
+	wide acc[num_limbs];
+	std::uint64_t neg = 0;
+	for(int i = 0; i < num_limbs; i++) acc[i] = lanes[i];
+	for(std::size_t i = 0; i < block; i++) neg += add_to(acc, values[i]);
+	for(int i = 0; i < num_limbs; i++) lanes[i] = acc[i];
+	negatives += neg;
+	pending += block;
+	values += block;
+	count -= block;
+      }
+    }
+
+    //merges another accumulator, e.g. one per thread in a reduction
+    big_int_accumulator<N> &operator+=(const big_int_accumulator<N> &other) noexcept {
+      big_int_accumulator<N> copy(other);
+      copy.normalize();
+      normalize();
+      for(int i = 0; i < num_lanes; i++) lanes[i] += copy.lanes[i];
+      normalize();
+      negatives += copy.negatives;
+      total += copy.total;
+      return *this;
+    }
+
+    //the sum modulo 2^M; exact when M is big enough to hold it
+    template<int M = N>
+    big_int<M> value() const noexcept {
+      big_int_accumulator<N> copy(*this);
+      copy.normalize();
+      limb sum[num_lanes];
+      for(int i = 0; i < num_lanes; i++) sum[i] = (limb)copy.lanes[i];
+      const limb correction[2] = {(limb)negatives, (limb)(negatives >> LimbKernels::limb_bits)};
+      LimbKernels::sub_n(sum+num_limbs, sum+num_limbs, correction, 2);
+      bool negative = sum[num_lanes-1] >> (LimbKernels::limb_bits-1);
+      if(negative) LimbKernels::neg(sum, num_lanes);
+      return big_int<M>::from_magnitude(sum, num_lanes, negative);
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,164 @@
+#include "big_int.hpp"
+#include <cstddef>
+#include <type_traits>
+
+#ifndef BIG_INT_ARRAY_H
+#define BIG_INT_ARRAY_H
+
+namespace alexstrong {
+
+  //On-disk array of big_int<N>: a fixed header followed by count records of
+  //N/CHAR_BIT bytes each, exactly as big_int<N> holds them in memory (two's
+  //complement, most significant byte first). The records don't depend on the
+  //machine's byte order, so a file can be memory-mapped and used in place.
+  //
+  //header, with every field little-endian:
+  //  bytes  0-7   magic "BIGINTA" and a 0 byte
+  //  bytes  8-11  format version
+  //  bytes 12-15  N
+  //  bytes 16-19  record byte order, 0 for most significant byte first
+  //  bytes 20-23  header size, i.e. where the first record starts
+  //  bytes 24-31  count
+  struct big_int_array_header {
+    static constexpr std::size_t size = 32;
+    static constexpr std::uint32_t version = 1;
+
+    std::uint32_t num_bits;
+    std::uint64_t count;
+
+    void encode(unsigned char *dst) const {
+      const char magic[8] = "BIGINTA";
+      for(int i = 0; i < 8; i++) dst[i] = magic[i];
+      put(dst + 8, version, 4);
+      put(dst + 12, num_bits, 4);
+      put(dst + 16, 0, 4);
+      put(dst + 20, size, 4);
+      put(dst + 24, count, 8);
+    }
+
+    //false if the bytes aren't a header this version can read
+    bool decode(const unsigned char *src) {
+      const char magic[8] = "BIGINTA";
+      for(int i = 0; i < 8; i++) {
+	if(src[i] != (unsigned char)magic[i]) return false;
+      }
+      if(get(src + 8, 4) != version || get(src + 16, 4) != 0 || get(src + 20, 4) != size) return false;
+      num_bits = (std::uint32_t)get(src + 12, 4);
+      count = get(src + 24, 8);
+      return true;
+    }
+
+  private:
+    static void put(unsigned char *dst, std::uint64_t value, int bytes) {
+      for(int i = 0; i < bytes; i++) dst[i] = (unsigned char)(value >> (i*CHAR_BIT));
+    }
+
+    static std::uint64_t get(const unsigned char *src, int bytes) {
+      std::uint64_t ret = 0;
+      for(int i = 0; i < bytes; i++) ret |= (std::uint64_t)src[i] << (i*CHAR_BIT);
+      return ret;
+    }
+  };
+
+  //what reading records in place relies on
+  template<int N>
+  struct big_int_array_layout {
+    static_assert(std::is_trivially_copyable<big_int<N>>::value, "big_int must be trivially copyable");
+    static_assert(std::is_standard_layout<big_int<N>>::value, "big_int must be standard layout");
+    static_assert(sizeof(big_int<N>) == N/CHAR_BIT, "big_int must have no padding");
+    static_assert(alignof(big_int<N>) == 1, "big_int must be byte aligned");
+    static constexpr std::size_t stride = sizeof(big_int<N>);
+  };
+
+  //header and records in one write each
+  template<int N>
+  void write_big_int_array(std::ostream &os, const big_int<N> *data, std::size_t count) {
+    big_int_array_header header;
+    header.num_bits = N;
+    header.count = count;
+    unsigned char bytes[big_int_array_header::size];
+    header.encode(bytes);
+    os.write(reinterpret_cast<const char *>(bytes), big_int_array_header::size);
+    os.write(reinterpret_cast<const char *>(data), count * big_int_array_layout<N>::stride);
+  }
+
+  //reads a whole array back; sets failbit and returns nothing if the header
+  //is bad, is for a different N, or counts more records than the stream has
+  template<int N>
+  std::vector<big_int<N>> read_big_int_array(std::istream &is) {
+    std::vector<big_int<N>> ret;
+    unsigned char bytes[big_int_array_header::size];
+    big_int_array_header header;
+    if(!is.read(reinterpret_cast<char *>(bytes), big_int_array_header::size) ||
+       !header.decode(bytes) || header.num_bits != N) {
+      is.setstate(std::ios::failbit);
+      return ret;
+    }
+    //the count isn't trusted: records are read in bounded blocks, so a
+    //header that claims more than the stream holds fails on a short read
+    //instead of allocating for the claimed count up front
+    const std::size_t block = std::max<std::size_t>(1, (1 << 20) / big_int_array_layout<N>::stride);
+    std::uint64_t left = header.count;
+    while(left) {
+      std::size_t n = (std::size_t)std::min<std::uint64_t>(left, block);
+      std::size_t done = ret.size();
+      ret.resize(done + n);
+      if(!is.read(reinterpret_cast<char *>(ret.data() + done), n * big_int_array_layout<N>::stride)) {
+	ret.clear();
+	ret.shrink_to_fit();
+	return ret;
+      }
+      left -= n;
+    }
+    return ret;
+  }
+
+  //read-only view of an array file that is already in memory, e.g. through
+  //mmap; nothing is parsed or copied. Check valid() before using it.
+  template<int N>
+  class big_int_array_view {
+    const big_int<N> *first;
+    std::size_t count;
+    
+  public:
+    typedef const big_int<N> *iterator;
+
+    big_int_array_view() : first(nullptr), count(0) {
+    }
+
+    big_int_array_view(const void *mapped, std::size_t bytes) : first(nullptr), count(0) {
+      const unsigned char *src = static_cast<const unsigned char *>(mapped);
+      big_int_array_header header;
+      if(bytes < big_int_array_header::size || !header.decode(src) || header.num_bits != N) return;
+      if(header.count > (bytes - big_int_array_header::size) / big_int_array_layout<N>::stride) return;
+      first = reinterpret_cast<const big_int<N> *>(src + big_int_array_header::size);
+      count = header.count;
+    }
+
+    bool valid() const {
+      return first != nullptr;
+    }
+
+    const big_int<N> *data() const {
+      return first;
+    }
+
+    std::size_t size() const {
+      return count;
+    }
+
+    const big_int<N> &operator[](std::size_t i) const {
+      return first[i];
+    }
+
+    iterator begin() const {
+      return first;
+    }
+
+    iterator end() const {
+      return first + count;
+    }
+  };
+}
+
+#endif
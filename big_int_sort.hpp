@@ -0,0 +1,204 @@
+#include "big_int.hpp"
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <system_error>
+
+#ifndef BIG_INT_SORT_H
+#define BIG_INT_SORT_H
+
+namespace alexstrong {
+
+  //Radix sorting for arrays of big_int<N>. The bytes are kept most
+  //significant first, so once the sign bit is flipped they order the same
+  //way as the numbers and serve directly as radix digits. The sort is MSD:
+  //a byte that is the same across a bucket costs one counting pass and is
+  //skipped, and small buckets are finished with std::sort on compare().
+  //
+  //Large inputs split the first pass across threads and then hand the
+  //buckets out to whichever thread is free, largest first.
+  template<int N>
+  class big_int_sorter {
+    static constexpr int num_bytes = N/CHAR_BIT;
+    static constexpr int radix = 1 << CHAR_BIT;
+    //buckets this small go to std::sort
+    static constexpr std::size_t small = 64;
+    //inputs this small aren't worth starting threads for
+    static constexpr std::size_t parallel_min = 1 << 16;
+
+    static unsigned digit(const big_int<N> &value, int byte) noexcept {
+      return value.bitmap[byte] ^ (byte ? 0 : 1u << (CHAR_BIT-1));
+    }
+
+    //sorts a on bytes byte and up, with tmp as scratch of the same size
+    template<typename T, typename Key, typename Less>
+    static void msd(T *a, T *tmp, std::size_t n, int byte, const Key &key, const Less &less) {
+      for(; byte < num_bytes; byte++) {
+	if(n < small) {
+	  std::sort(a, a+n, less);
+	  return;
+	}
+	std::size_t count[radix] = {};
+	for(std::size_t i = 0; i < n; i++) count[key(a[i], byte)]++;
+	if(count[key(a[0], byte)] == n) continue;
+	std::size_t start[radix+1], pos[radix];
+	start[0] = 0;
+	for(int b = 0; b < radix; b++) {
+	  pos[b] = start[b];
+	  start[b+1] = start[b] + count[b];
+	}
+	for(std::size_t i = 0; i < n; i++) tmp[pos[key(a[i], byte)]++] = a[i];
+	std::copy(tmp, tmp+n, a);
+	for(int b = 0; b < radix; b++) {
+	  if(count[b] > 1) msd(a+start[b], tmp+start[b], count[b], byte+1, key, less);
+	}
+	return;
+      }
+    }
+
+    //calls f(0) .. f(threads-1), each on its own thread where possible
+    template<typename F>
+    static void run(unsigned threads, const F &f) {
+      std::vector<std::thread> workers;
+      for(unsigned t = 1; t < threads; t++) {
+	try {
+	  workers.emplace_back(f, t);
+	}
+	catch(const std::system_error &) {
+	  f(t);
+	}
+      }
+      f(0);
+      for(std::thread &w : workers) w.join();
+    }
+
+    template<typename T, typename Key, typename Less>
+    static void parallel_msd(T *a, T *tmp, std::size_t n, const Key &key, const Less &less, unsigned threads) {
+      if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+      if(threads == 1 || n < parallel_min) {
+	msd(a, tmp, n, 0, key, less);
+	return;
+      }
+      const std::size_t chunk = (n + threads - 1) / threads;
+      auto first = [&](unsigned t) { return std::min(n, t*chunk); };
+      auto last = [&](unsigned t) { return std::min(n, (t+1)*chunk); };
+      std::vector<std::array<std::size_t, radix>> count(threads);
+      std::array<std::size_t, radix+1> start;
+      int byte = 0;
+      for(; byte < num_bytes; byte++) {
+	run(threads, [&](unsigned t) {
+	  count[t].fill(0);
+	  for(std::size_t i = first(t); i < last(t); i++) count[t][key(a[i], byte)]++;
+	});
+	start[0] = 0;
+	for(int b = 0; b < radix; b++) {
+	  start[b+1] = start[b];
+	  for(unsigned t = 0; t < threads; t++) start[b+1] += count[t][b];
+	}
+	unsigned b = key(a[0], byte);
+	if(start[b+1] - start[b] != n) break;
+      }
+      if(byte == num_bytes) return;
+      //each thread scatters its chunk behind those of the threads before it
+      std::vector<std::array<std::size_t, radix>> pos(threads);
+      for(int b = 0; b < radix; b++) {
+	std::size_t p = start[b];
+	for(unsigned t = 0; t < threads; t++) {
+	  pos[t][b] = p;
+	  p += count[t][b];
+	}
+      }
+      run(threads, [&](unsigned t) {
+	for(std::size_t i = first(t); i < last(t); i++) tmp[pos[t][key(a[i], byte)]++] = a[i];
+      });
+      run(threads, [&](unsigned t) {
+	std::copy(tmp+first(t), tmp+last(t), a+first(t));
+      });
+      std::array<int, radix> order;
+      for(int b = 0; b < radix; b++) order[b] = b;
+      std::sort(order.begin(), order.end(), [&](int x, int y) {
+	return start[x+1] - start[x] > start[y+1] - start[y];
+      });
+      std::atomic<int> next(0);
+      run(threads, [&](unsigned) {
+	for(int i = next++; i < radix; i = next++) {
+	  int b = order[i];
+	  std::size_t size = start[b+1] - start[b];
+	  if(size > 1) msd(a+start[b], tmp+start[b], size, byte+1, key, less);
+	}
+      });
+    }
+
+  public:
+    //threads == 0 uses every hardware thread
+    static void sort(big_int<N> *data, std::size_t count, unsigned threads = 0) {
+      std::vector<big_int<N>> tmp(count);
+      auto key = [](const big_int<N> &value, int byte) {
+	return digit(value, byte);
+      };
+      auto less = [](const big_int<N> &x, const big_int<N> &y) {
+	return x.compare(y) < 0;
+      };
+      parallel_msd(data, tmp.data(), count, key, less, threads);
+    }
+
+    //indices that would sort data; equal values keep their order
+    static std::vector<std::size_t> argsort(const big_int<N> *data, std::size_t count, unsigned threads = 0) {
+      std::vector<std::size_t> ret(count), tmp(count);
+      for(std::size_t i = 0; i < count; i++) ret[i] = i;
+      auto key = [data](std::size_t i, int byte) {
+	return digit(data[i], byte);
+      };
+      auto less = [data](std::size_t i, std::size_t j) {
+	int c = data[i].compare(data[j]);
+	return c ? c < 0 : i < j;
+      };
+      parallel_msd(ret.data(), tmp.data(), count, key, less, threads);
+      return ret;
+    }
+  };
+
+  template<int N>
+  void sort_big_ints(big_int<N> *data, std::size_t count, unsigned threads = 0) {
+    big_int_sorter<N>::sort(data, count, threads);
+  }
+
+  template<int N>
+  std::vector<std::size_t> argsort_big_ints(const big_int<N> *data, std::size_t count, unsigned threads = 0) {
+    return big_int_sorter<N>::argsort(data, count, threads);
+  }
+
+  //the smallest of count values, or data+count if there are none
+  template<int N>
+  const big_int<N> *min_big_int(const big_int<N> *data, std::size_t count) noexcept {
+    return std::min_element(data, data+count, [](const big_int<N> &x, const big_int<N> &y) {
+      return x.compare(y) < 0;
+    });
+  }
+
+  //the largest of count values, or data+count if there are none
+  template<int N>
+  const big_int<N> *max_big_int(const big_int<N> *data, std::size_t count) noexcept {
+    return std::max_element(data, data+count, [](const big_int<N> &x, const big_int<N> &y) {
+      return x.compare(y) < 0;
+    });
+  }
+
+  //the first of count sorted values that isn't less than value
+  template<int N>
+  const big_int<N> *lower_bound_big_int(const big_int<N> *data, std::size_t count, const big_int<N> &value) noexcept {
+    return std::lower_bound(data, data+count, value, [](const big_int<N> &x, const big_int<N> &y) {
+      return x.compare(y) < 0;
+    });
+  }
+
+  //the first of count sorted values that is greater than value
+  template<int N>
+  const big_int<N> *upper_bound_big_int(const big_int<N> *data, std::size_t count, const big_int<N> &value) noexcept {
+    return std::upper_bound(data, data+count, value, [](const big_int<N> &x, const big_int<N> &y) {
+      return x.compare(y) < 0;
+    });
+  }
+}
+
+#endif
@@ -1,7 +1,16 @@
 #include "big_int.hpp"
+#include "big_uint.hpp"
+#include "big_int_array.hpp"
+#include "big_int_accumulator.hpp"
+#include "big_int_sort.hpp"
+#include "rns_int.hpp"
 #include <cassert>
 #include <iostream>
 #include <typeinfo>
+#include <random>
+#include <sstream>
+#include <iomanip>
+#include <vector>
 
 using namespace alexstrong;
 
@@ -27,5 +36,250 @@ int main() {
   x3 *= x1;
   std::cout << "multiplication done" << std::endl;
   std::cout << x3 << std::endl;
+
+  std::cout << "Testing gcd, lcm, xgcd and mod_inverse." << std::endl;
+  big_int<256> g1("177926436589819713352431924481413923087695574108460");
+  big_int<256> g2("37688827764534557648103803035000790388215507475");
+  assert(gcd(g1, g2) == big_int<256>("714261560713930305765"));
+  assert(gcd(-g1, g2) == big_int<256>("714261560713930305765"));
+  assert(lcm(g1, g2) == big_int<256>("9388491824603252890746912401458522041112176082671632074325941110813420870900"));
+  assert(gcd(g1, big_int<256>()) == g1);
+  big_int<256> inv_a("809211367883644948340756718762644");
+  big_int<256> inv_m("634379244761142299989392387076880513");
+  auto bezout = xgcd(inv_a, inv_m);
+  assert(bezout.gcd == big_int<256>(1));
+  assert(bezout.x == big_int<256>("-225777453013158713353360778123785148"));
+  assert(bezout.y == big_int<256>("288000723697785427530495595671601"));
+  assert(mod_inverse(inv_a, inv_m) == big_int<256>("408601791747983586636031608953095365"));
+  assert(mod_inverse(-inv_a, inv_m) == big_int<256>("225777453013158713353360778123785148"));
+  assert(mod_inverse(g1, g2) == big_int<256>());
+
+  std::cout << "Testing isqrt, iroot and is_perfect_power." << std::endl;
+  big_int<512> sq("31657816837551135306566942770343217375082307201434731741292725305303954684352425895372399923843583945");
+  auto sq_data = isqrt_rem(sq);
+  assert(sq_data.root == big_int<512>("177926436589819713352431924481413923087695574108460"));
+  assert(sq_data.remainder == big_int<512>(12345));
+  assert(isqrt(big_int<512>(99)) == big_int<512>(9));
+  big_int<512> cube("123456789012345678901234567890");
+  assert(iroot(cube, 3) == big_int<512>("4979338592"));
+  assert(iroot(cube, 7) == big_int<512>(14319));
+  assert(iroot(-cube, 3) == big_int<512>("-4979338592"));
+  big_int<512> fifth("9397770624714917670640718964629643458189703179186369839394117902425775274897898284021172241137735700522396876483707");
+  big_int<512> base;
+  int exponent;
+  assert(fifth.is_perfect_power(base, exponent));
+  assert(base == big_int<512>("98765432109876543210987") && exponent == 5);
+  assert(!is_perfect_power(sq));
+  assert(is_perfect_power(big_int<512>(1024)));
+  //8000 bits: residue filters have to reject nearly every exponent before
+  //a root is taken, or this takes seconds
+  big_int<8192> wide_value = (big_int<8192>(1) << 7999) | big_int<8192>(12345);
+  assert(wide_value.perfect_power_candidates() == 0);
+  assert(!is_perfect_power(wide_value));
+  assert(iroot(wide_value, 7919) == big_int<8192>(2));
+  big_uint<8192> seventh_base = (big_uint<8192>(1) << 1100) + 3, seventh(1);
+  for(int i = 0; i < 7; i++) seventh *= seventh_base;
+  big_int<8192> wide_base;
+  assert(seventh.to_big_int().perfect_power_candidates() <= 2);
+  assert(seventh.to_big_int().is_perfect_power(wide_base, exponent) && exponent == 7);
+  assert(big_uint<8192>(wide_base) == seventh_base);
+
+  std::cout << "Testing is_probable_prime, next_prime and random_prime." << std::endl;
+  big_int<256> mersenne("170141183460469231731687303715884105727");
+  assert(is_probable_prime(mersenne));
+  assert(!is_probable_prime(big_int<256>("1427247692705959880439315947500961989719490561")));
+  //2^41-1 fools a base-2 Miller-Rabin test but not the Lucas test
+  assert(!is_probable_prime(big_int<256>("2199023255551")));
+  assert(!is_probable_prime(big_int<256>(561)));
+  assert(is_probable_prime(big_int<256>(65521)));
+  assert(!is_probable_prime(-mersenne));
+  assert(next_prime(big_int<256>("1000000000000000000000000000000")) == big_int<256>("1000000000000000000000000000057"));
+  assert(next_prime(big_int<256>(1)) == big_int<256>(2));
+  std::mt19937 gen(28);
+  big_int<256> p = random_prime<256>(200, gen);
+  assert(p.bit_length() == 200);
+  assert(is_probable_prime(p));
+
+  std::cout << "Testing random_bits, random_below and random_range." << std::endl;
+  std::mt19937_64 gen64(29);
+  big_int<256> bound("12345678901234567890123456789");
+  big_int<256> lo("-1000000000000000000000"), hi("1000");
+  for(int i = 0; i < 100; i++) {
+    big_int<256> r = random_below(bound, gen64);
+    assert(r >= big_int<256>() && r < bound);
+    r = random_range(lo, hi, gen);
+    assert(r >= lo && r <= hi);
+    assert(random_bits<256>(100, gen64).bit_length() <= 100);
+  }
+  assert(random_below(big_int<256>(1), gen) == big_int<256>());
+  assert(random_range(hi, hi, gen) == hi);
+
+  std::cout << "Testing big_uint." << std::endl;
+  big_uint<256> hash("FEDCBA9876543210FEDCBA9876543210FEDCBA9876543210FEDCBA9876543210", 16);
+  assert(hash.bit_length() == 256);
+  assert(hash.to_base(16) == "FEDCBA9876543210FEDCBA9876543210FEDCBA9876543210FEDCBA9876543210");
+  assert(hash + big_uint<256>(0x0123456789ABCDEFULL) - big_uint<256>(0x0123456789ABCDEFULL) == hash);
+  assert(~hash + 1 == -hash);
+  assert(big_uint<256>() - 1 == ~big_uint<256>());
+  big_uint<64> counter(0xFFFFFFFFFFFFFFFFULL);
+  assert((++counter).is_zero());
+  big_uint<256> factor("18446744073709551629");
+  assert((factor * factor) / factor == factor);
+  assert((factor * factor + 5) % factor == big_uint<256>(5));
+  assert((hash >> 252).to_ull() == 0xF);
+  assert((hash << 248).to_base(16) == "1000000000000000000000000000000000000000000000000000000000000000");
+  assert(big_uint<256>(hash.to_big_int()) == hash);
+  assert(big_uint<256>(-big_int<256>(5)) == big_uint<256>() - 5 && big_uint<256>(-big_int<256>(5)).bit_length() == 256);
+  assert(big_uint<256>(-big_int<256>(1)) == ~big_uint<256>());
+  assert(big_uint<256>(1) < hash && hash > factor);
+
+  std::cout << "Testing export_bytes, import_bytes and the array format." << std::endl;
+  big_int<128> stored("-123456789012345678901234567890");
+  unsigned char raw[big_int<128>::num_bytes];
+  stored.export_bytes(raw, byte_order::little_endian);
+  assert(raw[0] == 0x2E && raw[15] == 0xFF);
+  assert(big_int<128>::import_bytes(raw, byte_order::little_endian) == stored);
+  export_bytes(stored, raw);
+  assert(raw[0] == 0xFF && raw[15] == 0x2E);
+  assert(import_bytes<128>(raw) == stored);
+  std::vector<big_int<128>> values;
+  for(int i = 0; i < 10; i++) values.push_back(random_bits<128>(gen));
+  values.push_back(stored);
+  std::stringstream file;
+  write_big_int_array(file, values.data(), values.size());
+  std::string contents = file.str();
+  assert(contents.size() == big_int_array_header::size + values.size()*16);
+  big_int_array_view<128> view(contents.data(), contents.size());
+  assert(view.valid() && view.size() == values.size());
+  for(std::size_t i = 0; i < values.size(); i++) assert(view[i] == values[i]);
+  assert(!big_int_array_view<256>(contents.data(), contents.size()).valid());
+  assert(!big_int_array_view<128>(contents.data(), contents.size()-1).valid());
+  std::vector<big_int<128>> reloaded = read_big_int_array<128>(file);
+  assert(reloaded.size() == values.size() && reloaded.back() == stored);
+  std::string inflated = contents;
+  inflated[24+4] = 4;
+  std::istringstream truncated(inflated);
+  assert(read_big_int_array<128>(truncated).empty() && truncated.fail());
+
+  std::cout << "Testing streaming parse and format." << std::endl;
+  std::string digits = "9";
+  while(digits.length() < 600) digits.push_back('0' + gen() % 10);
+  big_int<2048> parsed(digits);
+  assert(parsed.to_base(10) == digits);
+  assert(parsed.to_base(16) == big_uint<2048>(digits).to_base(16));
+  assert(big_int<2048>(parsed.to_base(36), 36) == parsed);
+  assert((-parsed).to_base(10) == "-" + digits);
+  big_int_parser<2048> parser;
+  assert(parser.feed("-", 1) == 1);
+  for(std::size_t i = 0; i < digits.length(); i += 7) {
+    std::string piece = digits.substr(i, 7);
+    assert(parser.feed(piece.data(), piece.length()) == piece.length());
+  }
+  assert(parser.feed("12x4", 4) == 2 && parser.done());
+  assert(parser.value() == big_int<2048>("-" + digits + "12"));
+  big_int_formatter<2048> formatter(-parsed);
+  assert(formatter.length() == digits.length()+1);
+  std::string pieces;
+  char piece[5];
+  while(!formatter.done()) pieces.append(piece, formatter.read(piece, sizeof(piece)));
+  assert(pieces == "-" + digits);
+  assert(big_int<64>("").to_base(10) == "0" && big_int<64>("-").to_base(10) == "0");
+  std::istringstream input("  " + digits + " -42,ff +x");
+  big_int<2048> read_back;
+  big_int<64> small;
+  assert(input >> read_back && read_back == parsed);
+  assert(input >> small && small == -big_int<64>(42) && input.get() == ',');
+  assert(input >> std::hex >> small && small == big_int<64>(255));
+  assert(!(input >> std::dec >> small) && small == big_int<64>(0));
+  std::istringstream too_big("40000 -32768 -32769 32767 99999999999999999999999999");
+  big_int<16> word;
+  assert(!(too_big >> word) && word == big_int<16>("32767"));
+  too_big.clear();
+  assert(too_big >> word && word == big_int<16>("-32768"));
+  assert(!(too_big >> word) && word == big_int<16>("-32768"));
+  too_big.clear();
+  assert(too_big >> word && word == big_int<16>("32767"));
+  assert(!(too_big >> small) && small == big_int<64>("9223372036854775807"));
+  std::ostringstream output;
+  output << parsed << ' ' << std::hex << big_int<64>(255);
+  assert(output.str() == digits + " FF");
+  std::ostringstream padded;
+  padded << std::setw(6) << big_int<64>(42) << "|" << std::left << std::setw(5) << big_int<64>(42) << "|";
+  padded << std::internal << std::setfill('0') << std::setw(6) << -big_int<64>(42) << "|" << big_int<64>(7);
+  assert(padded.str() == "    42|42   |-00042|7");
+
+  std::cout << "Testing big_int_accumulator." << std::endl;
+  std::vector<big_int<200>> amounts;
+  for(int i = 0; i < 1000; i++) amounts.push_back(random_bits<200>(gen));
+  amounts.push_back(big_int<200>(1) << 199);
+  big_uint<512> expected;
+  big_int_accumulator<200> ledger, first_half, second_half;
+  for(std::size_t i = 0; i < amounts.size(); i++) {
+    expected += big_uint<512>(big_uint<200>(amounts[i]));
+    if(!amounts[i].sign()) expected -= big_uint<512>(1) << 200;
+    ledger += amounts[i];
+    if(i == 500) ledger.normalize();
+  }
+  first_half.add(amounts.data(), 400);
+  second_half.add(amounts.data()+400, amounts.size()-400);
+  first_half += second_half;
+  assert(ledger.count() == amounts.size() && first_half.count() == amounts.size());
+  assert(big_uint<512>(ledger.value<512>()) == expected);
+  assert(first_half.value<512>() == ledger.value<512>());
+  assert(ledger.value() == big_uint<200>(expected).to_big_int());
+  big_int_accumulator<200> cancel;
+  cancel += amounts[0];
+  cancel += -amounts[0];
+  assert(cancel.value<512>() == big_int<512>(0));
+
+  std::cout << "Testing sort_big_ints and argsort_big_ints." << std::endl;
+  std::vector<big_int<128>> keys;
+  for(int i = 0; i < 100000; i++) {
+    //mix of full-width keys, small ones with constant top bytes, and repeats
+    if(i % 3 == 0) keys.push_back(random_bits<128>(gen));
+    else if(i % 3 == 1) keys.push_back(random_below(big_int<128>(1000), gen) - big_int<128>(500));
+    else keys.push_back(keys[gen() % keys.size()]);
+  }
+  auto less = [](const big_int<128> &x, const big_int<128> &y) { return x.compare(y) < 0; };
+  std::vector<big_int<128>> sorted = keys, parallel = keys, small_keys(keys.begin(), keys.begin()+50);
+  std::sort(sorted.begin(), sorted.end(), less);
+  sort_big_ints(parallel.data(), parallel.size(), 4);
+  for(std::size_t i = 0; i < sorted.size(); i++) assert(parallel[i].compare(sorted[i]) == 0);
+  std::vector<std::size_t> order = argsort_big_ints(keys.data(), keys.size(), 4);
+  for(std::size_t i = 0; i < order.size(); i++) {
+    assert(keys[order[i]].compare(sorted[i]) == 0);
+    if(i) assert(keys[order[i-1]].compare(keys[order[i]]) || order[i-1] < order[i]);
+  }
+  sort_big_ints(small_keys.data(), small_keys.size(), 1);
+  assert(std::is_sorted(small_keys.begin(), small_keys.end(), less));
+  assert(min_big_int(keys.data(), keys.size())->compare(sorted.front()) == 0);
+  assert(max_big_int(keys.data(), keys.size())->compare(sorted.back()) == 0);
+  const big_int<128> *low = lower_bound_big_int(sorted.data(), sorted.size(), big_int<128>(7));
+  const big_int<128> *high = upper_bound_big_int(sorted.data(), sorted.size(), big_int<128>(7));
+  assert(low->compare(big_int<128>(7)) >= 0 && (low == sorted.data() || low[-1].compare(big_int<128>(7)) < 0));
+  assert(std::count_if(keys.begin(), keys.end(), [](const big_int<128> &x) { return x.compare(big_int<128>(7)) == 0; }) == high - low);
+
+  std::cout << "Testing rns_int." << std::endl;
+  for(int i = 1; i < rns_int<256>::num_channels; i++) {
+    assert(rns_int<256>::modulus(i) < rns_int<256>::modulus(i-1));
+  }
+  big_int<256> left("-98765432109876543210987654321098765432109876543210987654321");
+  big_int<256> right("12345678901234567890123456789012345678901234567890123456789");
+  rns_int<256> rleft(left), rright(right);
+  assert(rleft.to_big_int() == left && rright.to_big_int() == right);
+  assert((rleft + rright).to_big_int() == big_int<256>("-86419753208641975320864197532086419753208641975320864197532"));
+  assert((rright - rleft).to_big_int() == big_int<256>("111111111011111111101111111110111111111011111111101111111110"));
+  rns_int<256> rproduct = rleft * rright;
+  assert(rproduct.to_big_int<512>() == big_int<512>("-1219326311370217952261850327338667885945115073915636335923673677792956119493974487120865336229233322374638011112635269"));
+  for(int i = 0; i < rns_int<256>::num_channels; i++) {
+    assert(rproduct.residue(i) == rproduct.base_extend(rns_int<256>::modulus(i)));
+  }
+  assert(rproduct.base_extend(1000003) == 291503);
+  assert(rproduct.mod(right) == rns_int<256>(0) && rproduct.mod(big_int<256>(1000)).to_big_int() == big_int<256>(731));
+  assert(rns_int<256>(-7) * rns_int<256>(6) == -rns_int<256>(42));
+  assert(rns_int<256>(-1) * rns_int<256>(-1) == rns_int<256>(1));
+  std::ostringstream printed;
+  printed << rns_int<64>(-123456789012345LL);
+  assert(printed.str() == "-123456789012345");
   return 0;
 }
@@ -0,0 +1,324 @@
+#include "big_int.hpp"
+
+#ifndef BIG_UINT_H
+#define BIG_UINT_H
+
+namespace alexstrong {
+
+  //an unsigned integer of N bits. Arithmetic wraps around modulo 2^N, and
+  //the limbs are kept in the form LimbKernels works on, so nothing has to
+  //be converted, sign extended or negated on the way in or out.
+  template<int N>
+  class big_uint {
+    static_assert(N % CHAR_BIT == 0, "Invalid number of bits; " STRINGIFY(N) " is not a multiple of " STRINGIFY(CHAR_BIT));
+    static_assert(N>0, "Number of bits must be positive.");
+
+    typedef LimbKernels::limb limb;
+    typedef LimbKernels::wide wide;
+
+    static constexpr int num_limbs = LimbKernels::limbs_for_bytes(N/CHAR_BIT);
+
+    //little-endian limbs; bits at or above N are always 0
+    limb limbs[num_limbs];
+
+    void wrap() noexcept {
+      LimbKernels::mask_bits(limbs, num_limbs, N);
+    }
+
+    struct division_data {
+      big_uint<N> quotient;
+      big_uint<N> remainder;
+    };
+
+    //dividing by 0 gives 0 for both
+    division_data divide(const big_uint<N> &other) const noexcept {
+      division_data ret;
+      if(LimbKernels::is_zero(other.limbs, num_limbs)) return ret;
+      LimbKernels::divmod(ret.quotient.limbs, ret.remainder.limbs, limbs, num_limbs, other.limbs, num_limbs);
+      return ret;
+    }
+
+  public:
+    template<int M>
+    friend class big_uint;
+
+    static constexpr int num_bits = N;
+    static constexpr int num_bytes = N/CHAR_BIT;
+
+    //default constructor - sets everything to 0
+    big_uint() noexcept {
+      LimbKernels::zero(limbs, num_limbs);
+    }
+
+    big_uint(unsigned long long value) noexcept {
+      LimbKernels::set_wide(limbs, num_limbs, value);
+      wrap();
+    }
+
+    //string constructor; stops at the first character that isn't a digit
+    big_uint(const std::string &value, int base = 10) noexcept {
+      assert(base <= 36 && base > 1);
+      LimbKernels::zero(limbs, num_limbs);
+      int digits;
+      const limb power = LimbKernels::chunk_power(base, digits);
+      limb chunk = 0;
+      limb scale = 1;
+      for(char c : value) {
+	int d = digit_value(c);
+	if(d >= base) break;
+	chunk = chunk*base + d;
+	scale *= base;
+	if(scale == power) {
+	  LimbKernels::mul_1(limbs, limbs, num_limbs, scale);
+	  LimbKernels::add_1(limbs, limbs, num_limbs, chunk);
+	  chunk = 0;
+	  scale = 1;
+	}
+      }
+      if(scale > 1) {
+	LimbKernels::mul_1(limbs, limbs, num_limbs, scale);
+	LimbKernels::add_1(limbs, limbs, num_limbs, chunk);
+      }
+      wrap();
+    }
+
+    //same bits as a big_int, so negative numbers wrap around to 2^N - |x|
+    explicit big_uint(const big_int<N> &other) noexcept {
+      LimbKernels::from_bytes(limbs, num_limbs, other.bitmap, N/CHAR_BIT);
+    }
+
+    //truncates or zero extends
+    template<int M>
+    explicit big_uint(const big_uint<M> &other) noexcept {
+      for(int i = 0; i < num_limbs; i++) {
+	limbs[i] = (i < big_uint<M>::num_limbs) ? other.limbs[i] : 0;
+      }
+      wrap();
+    }
+
+    //same bits as a big_int, so values of 2^(N-1) and up come out negative
+    big_int<N> to_big_int() const noexcept {
+      big_int<N> ret;
+      LimbKernels::to_bytes(ret.bitmap, N/CHAR_BIT, limbs, num_limbs);
+      return ret;
+    }
+
+    //low bits only
+    unsigned long long to_ull() const noexcept {
+      return LimbKernels::get_wide(limbs, num_limbs);
+    }
+
+    int bit_length() const noexcept {
+      return LimbKernels::bit_length(limbs, num_limbs);
+    }
+
+    bool is_zero() const noexcept {
+      return LimbKernels::is_zero(limbs, num_limbs);
+    }
+
+    big_uint<N> &operator+=(const big_uint<N> &other) noexcept {
+      LimbKernels::add_n(limbs, limbs, other.limbs, num_limbs);
+      wrap();
+      return *this;
+    }
+
+    big_uint<N> &operator-=(const big_uint<N> &other) noexcept {
+      LimbKernels::sub_n(limbs, limbs, other.limbs, num_limbs);
+      wrap();
+      return *this;
+    }
+
+    big_uint<N> &operator*=(const big_uint<N> &other) noexcept {
+      limb prod[num_limbs];
+      LimbKernels::mul_low(prod, limbs, other.limbs, num_limbs);
+      LimbKernels::copy(limbs, prod, num_limbs);
+      wrap();
+      return *this;
+    }
+
+    big_uint<N> &operator/=(const big_uint<N> &other) noexcept {
+      *this = divide(other).quotient;
+      return *this;
+    }
+
+    big_uint<N> &operator%=(const big_uint<N> &other) noexcept {
+      *this = divide(other).remainder;
+      return *this;
+    }
+
+    big_uint<N> &operator&=(const big_uint<N> &other) noexcept {
+      for(int i = 0; i < num_limbs; i++) limbs[i] &= other.limbs[i];
+      return *this;
+    }
+
+    big_uint<N> &operator|=(const big_uint<N> &other) noexcept {
+      for(int i = 0; i < num_limbs; i++) limbs[i] |= other.limbs[i];
+      return *this;
+    }
+
+    big_uint<N> &operator^=(const big_uint<N> &other) noexcept {
+      for(int i = 0; i < num_limbs; i++) limbs[i] ^= other.limbs[i];
+      return *this;
+    }
+
+    //shifts fill with 0 and drop anything shifted past either end
+    big_uint<N> &operator<<=(const int &other) noexcept {
+      if(other >= N) LimbKernels::zero(limbs, num_limbs);
+      else LimbKernels::shl(limbs, num_limbs, other);
+      wrap();
+      return *this;
+    }
+
+    big_uint<N> &operator>>=(const int &other) noexcept {
+      if(other >= N) LimbKernels::zero(limbs, num_limbs);
+      else LimbKernels::shr(limbs, num_limbs, other);
+      return *this;
+    }
+
+    big_uint<N> operator<<(const int &other) const noexcept {
+      big_uint<N> ret(*this);
+      ret <<= other;
+      return ret;
+    }
+
+    big_uint<N> operator>>(const int &other) const noexcept {
+      big_uint<N> ret(*this);
+      ret >>= other;
+      return ret;
+    }
+
+    big_uint<N> operator~() const noexcept {
+      big_uint<N> ret;
+      for(int i = 0; i < num_limbs; i++) ret.limbs[i] = ~limbs[i];
+      ret.wrap();
+      return ret;
+    }
+
+    //2^N - x
+    big_uint<N> operator-() const noexcept {
+      big_uint<N> ret(*this);
+      LimbKernels::neg(ret.limbs, num_limbs);
+      ret.wrap();
+      return ret;
+    }
+
+    //prefix operator++
+    big_uint<N> &operator++() noexcept {
+      LimbKernels::add_1(limbs, limbs, num_limbs, 1);
+      wrap();
+      return *this;
+    }
+
+    //postfix operator++
+    big_uint<N> operator++(int) noexcept {
+      big_uint<N> copy(*this);
+      ++(*this);
+      return copy;
+    }
+
+    //prefix operator--
+    big_uint<N> &operator--() noexcept {
+      LimbKernels::sub_1(limbs, limbs, num_limbs, 1);
+      wrap();
+      return *this;
+    }
+
+    //postfix operator--
+    big_uint<N> operator--(int) noexcept {
+      big_uint<N> copy(*this);
+      --(*this);
+      return copy;
+    }
+
+    friend big_uint<N> operator+(big_uint<N> a, const big_uint<N> &b) noexcept {
+      return a += b;
+    }
+
+    friend big_uint<N> operator-(big_uint<N> a, const big_uint<N> &b) noexcept {
+      return a -= b;
+    }
+
+    friend big_uint<N> operator*(big_uint<N> a, const big_uint<N> &b) noexcept {
+      return a *= b;
+    }
+
+    friend big_uint<N> operator/(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      return a.divide(b).quotient;
+    }
+
+    friend big_uint<N> operator%(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      return a.divide(b).remainder;
+    }
+
+    friend big_uint<N> operator&(big_uint<N> a, const big_uint<N> &b) noexcept {
+      return a &= b;
+    }
+
+    friend big_uint<N> operator|(big_uint<N> a, const big_uint<N> &b) noexcept {
+      return a |= b;
+    }
+
+    friend big_uint<N> operator^(big_uint<N> a, const big_uint<N> &b) noexcept {
+      return a ^= b;
+    }
+
+    //comparisons are a single scan from the top limb down
+    friend bool operator==(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      for(int i = 0; i < num_limbs; i++) {
+	if(a.limbs[i] != b.limbs[i]) return false;
+      }
+      return true;
+    }
+
+    friend bool operator!=(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      return !(a == b);
+    }
+
+    friend bool operator<(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      for(int i = num_limbs-1; i >= 0; i--) {
+	if(a.limbs[i] != b.limbs[i]) return a.limbs[i] < b.limbs[i];
+      }
+      return false;
+    }
+
+    friend bool operator>(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      return b < a;
+    }
+
+    friend bool operator<=(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      return !(b < a);
+    }
+
+    friend bool operator>=(const big_uint<N> &a, const big_uint<N> &b) noexcept {
+      return !(a < b);
+    }
+
+    //get string representation in any base <= 36
+    std::string to_base(int base) const {
+      assert(base <= 36 && base > 1);
+      int digits;
+      const limb power = LimbKernels::chunk_power(base, digits);
+      limb copy[num_limbs];
+      LimbKernels::copy(copy, limbs, num_limbs);
+      std::string ret = "";
+      while(!LimbKernels::is_zero(copy, num_limbs)) {
+	limb chunk = LimbKernels::divmod_1(copy, copy, num_limbs, power);
+	bool last = LimbKernels::is_zero(copy, num_limbs);
+	for(int i = 0; i < digits && (chunk || !last); i++) {
+	  ret.push_back(uppercase_digits[chunk % base]);
+	  chunk /= base;
+	}
+      }
+      if(ret.empty()) ret = "0";
+      return std::string(ret.rbegin(), ret.rend());
+    }
+
+    //output
+    friend std::ostream &operator<<(std::ostream &os, const big_uint<N> &num) {
+      os << num.to_base(10);
+      return os;
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,288 @@
+#include "big_int.hpp"
+
+#ifndef RNS_INT_H
+#define RNS_INT_H
+
+namespace alexstrong {
+
+  //a fixed set of count primes just below 2^31 and the constants CRT needs
+  //for them. Built once per count, the first time it is asked for.
+  template<int count>
+  class rns_basis {
+    typedef LimbKernels::limb limb;
+    typedef LimbKernels::wide wide;
+
+    static limb pow_mod(limb base, limb exp, limb p) noexcept {
+      wide ret = 1, b = base % p;
+      while(exp) {
+	if(exp & 1) ret = ret * b % p;
+	b = b * b % p;
+	exp >>= 1;
+      }
+      return (limb)ret;
+    }
+
+    //trial division by every prime up to 2^16 decides anything below 2^32
+    static bool is_prime(limb n) noexcept {
+      if(n % 2 == 0) return n == 2;
+      for(limb p : SmallPrimes::primes()) {
+	if((wide)p * p > n) break;
+	if(n % p == 0) return false;
+      }
+      return true;
+    }
+
+    rns_basis() {
+      limb candidate = 0x7FFFFFFFu;
+      for(int i = 0; i < count; i++) {
+	while(!is_prime(candidate)) candidate -= 2;
+	moduli[i] = candidate;
+	candidate -= 2;
+      }
+      prefix.resize(count*count);
+      for(int i = 0; i < count; i++) {
+	wide p = 1;
+	for(int j = 0; j <= i; j++) {
+	  prefix[i*count+j] = (limb)p;
+	  p = p * moduli[j] % moduli[i];
+	}
+	inverse[i] = pow_mod(prefix[i*count+i], moduli[i]-2, moduli[i]);
+	reciprocal[i] = (limb)(((wide)1 << 62) / moduli[i]);
+      }
+      product.fill(0);
+      product[0] = 1;
+      for(int i = 0; i < count; i++) LimbKernels::mul_1(product.data(), product.data(), count, moduli[i]);
+      half = product;
+      LimbKernels::shr(half.data(), count, 1);
+    }
+
+  public:
+    std::array<limb, count> moduli;
+    //prefix[i*count+j] is moduli[0]*...*moduli[j-1] mod moduli[i], for j <= i
+    std::vector<limb> prefix;
+    //the inverse of prefix[i*count+i] mod moduli[i]
+    std::array<limb, count> inverse;
+    //floor(2^62 / moduli[i]) for Barrett reduction; below 2^32 since every
+    //modulus is above 2^30
+    std::array<limb, count> reciprocal;
+    //the product M of all the moduli, and M/2 rounded down
+    std::array<limb, count> product;
+    std::array<limb, count> half;
+
+    static const rns_basis<count> &get() {
+      static const rns_basis<count> basis;
+      return basis;
+    }
+  };
+
+  //Residue number system form of a big_int<N>: a value is held as its
+  //residues modulo num_channels primes below 2^31. Addition, subtraction and
+  //multiplication work on each channel alone, with no carries between them,
+  //and multiplication reduces with Barrett constants instead of a division.
+  //With g++ 12 at -O3 all three loops vectorize for AVX2
+  //(-march=x86-64-v3); plain SSE2 at -O3 gets + and - but not *.
+  //
+  //The product M of the moduli is above 2^(2N+2), and values are taken to
+  //lie in [-M/2, M/2). Any sum or product of N-bit values that stays within
+  //2N bits is therefore exact. Converting back to big_int<M> gives the low M
+  //bits, the same as big_int's own wrap-around.
+  template<int N>
+  class rns_int {
+    static_assert(N % CHAR_BIT == 0, "Invalid number of bits; " STRINGIFY(N) " is not a multiple of " STRINGIFY(CHAR_BIT));
+    static_assert(N>0, "Number of bits must be positive.");
+
+    typedef LimbKernels::limb limb;
+    typedef LimbKernels::wide wide;
+
+  public:
+    //every modulus is above 2^30
+    static constexpr int num_channels = (2*N+2)/30 + 1;
+
+  private:
+    typedef rns_basis<num_channels> basis;
+
+    limb residues[num_channels];
+
+    void from_magnitude(const limb *mag, int n, bool negative) noexcept {
+      const basis &b = basis::get();
+      for(int i = 0; i < num_channels; i++) {
+	limb r = LimbKernels::divmod_1(nullptr, mag, n, b.moduli[i]);
+	residues[i] = (negative && r) ? b.moduli[i] - r : r;
+      }
+    }
+
+    //Garner: the digits v of x = v[0] + v[1]*p0 + v[2]*p0*p1 + ..., each
+    //below its own modulus, and x itself in num_channels limbs. Returns
+    //true if x is past M/2, i.e. the value is x - M.
+    bool unpack(limb *v, limb *x) const noexcept {
+      const basis &b = basis::get();
+      for(int i = 0; i < num_channels; i++) {
+	const limb p = b.moduli[i];
+	const limb *prefix = &b.prefix[i*num_channels];
+	wide s = 0;
+	for(int j = 0; j < i; j++) s = (s + (wide)v[j] * prefix[j]) % p;
+	v[i] = (limb)((residues[i] + p - s) % p * b.inverse[i] % p);
+      }
+      LimbKernels::zero(x, num_channels);
+      for(int i = num_channels-1; i >= 0; i--) {
+	LimbKernels::mul_1(x, x, num_channels, b.moduli[i]);
+	LimbKernels::add_1(x, x, num_channels, v[i]);
+      }
+      return LimbKernels::cmp(x, num_channels, b.half.data(), num_channels) > 0;
+    }
+
+    //|value| in num_channels limbs; returns true if it is negative
+    bool to_magnitude(limb *mag) const noexcept {
+      std::array<limb, num_channels> v;
+      bool negative = unpack(v.data(), mag);
+      if(negative) LimbKernels::sub_n(mag, basis::get().product.data(), mag, num_channels);
+      return negative;
+    }
+
+  public:
+    //default constructor - sets everything to 0
+    rns_int() noexcept {
+      for(int i = 0; i < num_channels; i++) residues[i] = 0;
+    }
+
+    rns_int(long long value) noexcept {
+      bool negative = value < 0;
+      unsigned long long mag = negative ? 0ULL - (unsigned long long)value : value;
+      const limb limbs[2] = {(limb)mag, (limb)(mag >> LimbKernels::limb_bits)};
+      from_magnitude(limbs, 2, negative);
+    }
+
+    explicit rns_int(const big_int<N> &value) noexcept {
+      std::array<limb, big_int<N>::num_limbs> mag;
+      bool negative = value.to_magnitude(mag.data());
+      from_magnitude(mag.data(), big_int<N>::num_limbs, negative);
+    }
+
+    //the low M bits of the value
+    template<int M = N>
+    big_int<M> to_big_int() const noexcept {
+      std::array<limb, num_channels> mag;
+      bool negative = to_magnitude(mag.data());
+      return big_int<M>::from_magnitude(mag.data(), num_channels, negative);
+    }
+
+    static limb modulus(int channel) noexcept {
+      assert(channel >= 0 && channel < num_channels);
+      return basis::get().moduli[channel];
+    }
+
+    limb residue(int channel) const noexcept {
+      assert(channel >= 0 && channel < num_channels);
+      return residues[channel];
+    }
+
+    //base extension: the value mod any m > 0 that fits in a limb, worked
+    //out from the mixed-radix digits one limb at a time
+    limb base_extend(limb m) const noexcept {
+      assert(m > 0);
+      const basis &b = basis::get();
+      std::array<limb, num_channels> v, x;
+      bool negative = unpack(v.data(), x.data());
+      wide ret = 0, p = 1 % m;
+      for(int i = 0; i < num_channels; i++) {
+	ret = (ret + v[i] % m * p) % m;
+	p = p * (b.moduli[i] % m) % m;
+      }
+      //p is now M mod m
+      if(negative) ret = (ret + m - p) % m;
+      return (limb)ret;
+    }
+
+    //the value mod a positive divisor, in [0, divisor). This goes through
+    //the binary form, so use it between runs of channel arithmetic
+    rns_int<N> mod(const big_int<N> &divisor) const noexcept {
+      std::array<limb, big_int<N>::num_limbs> m;
+      bool negative_modulus = divisor.to_magnitude(m.data());
+      assert(!negative_modulus && !LimbKernels::is_zero(m.data(), big_int<N>::num_limbs));
+      (void)negative_modulus;
+      int nm = LimbKernels::size(m.data(), big_int<N>::num_limbs);
+      std::array<limb, num_channels> x;
+      bool negative = to_magnitude(x.data());
+      std::array<limb, big_int<N>::num_limbs> r;
+      LimbKernels::divmod(nullptr, r.data(), x.data(), num_channels, m.data(), nm);
+      if(negative && !LimbKernels::is_zero(r.data(), nm)) {
+	LimbKernels::sub_n(r.data(), m.data(), r.data(), nm);
+      }
+      rns_int<N> ret;
+      ret.from_magnitude(r.data(), nm, false);
+      return ret;
+    }
+
+    rns_int<N> &operator+=(const rns_int<N> &other) noexcept {
+      const basis &b = basis::get();
+      for(int i = 0; i < num_channels; i++) {
+	limb s = residues[i] + other.residues[i];
+	residues[i] = s >= b.moduli[i] ? s - b.moduli[i] : s;
+      }
+      return *this;
+    }
+
+    rns_int<N> &operator-=(const rns_int<N> &other) noexcept {
+      const basis &b = basis::get();
+      for(int i = 0; i < num_channels; i++) {
+	limb s = residues[i] + (b.moduli[i] - other.residues[i]);
+	residues[i] = s >= b.moduli[i] ? s - b.moduli[i] : s;
+      }
+      return *this;
+    }
+
+    //Barrett reduction, so a channel is only multiplies, shifts and
+    //subtracts: q underestimates x/p by at most 2, which the two
+    //conditional subtractions make up
+    rns_int<N> &operator*=(const rns_int<N> &other) noexcept {
+      const basis &b = basis::get();
+      for(int i = 0; i < num_channels; i++) {
+	const wide p = b.moduli[i];
+	wide x = (wide)residues[i] * other.residues[i];
+	wide q = ((wide)(limb)(x >> 30) * b.reciprocal[i]) >> 32;
+	wide r = x - (wide)(limb)q * p;
+	r = r >= p ? r - p : r;
+	r = r >= p ? r - p : r;
+	residues[i] = (limb)r;
+      }
+      return *this;
+    }
+
+    rns_int<N> operator-() const noexcept {
+      rns_int<N> ret;
+      ret -= *this;
+      return ret;
+    }
+
+    friend rns_int<N> operator+(rns_int<N> a, const rns_int<N> &b) noexcept {
+      return a += b;
+    }
+
+    friend rns_int<N> operator-(rns_int<N> a, const rns_int<N> &b) noexcept {
+      return a -= b;
+    }
+
+    friend rns_int<N> operator*(rns_int<N> a, const rns_int<N> &b) noexcept {
+      return a *= b;
+    }
+
+    friend bool operator==(const rns_int<N> &a, const rns_int<N> &b) noexcept {
+      for(int i = 0; i < num_channels; i++) {
+	if(a.residues[i] != b.residues[i]) return false;
+      }
+      return true;
+    }
+
+    friend bool operator!=(const rns_int<N> &a, const rns_int<N> &b) noexcept {
+      return !(a == b);
+    }
+
+    //output
+    friend std::ostream &operator<<(std::ostream &os, const rns_int<N> &num) {
+      os << num.template to_big_int<num_channels*LimbKernels::limb_bits>();
+      return os;
+    }
+  };
+}
+
+#endif